@@ -0,0 +1,43 @@
+#include "BootProfiler.h"
+
+BootProfiler::Phase BootProfiler::_ph[BootProfiler::kMaxPhases];
+uint8_t      BootProfiler::_n       = 0;
+uint64_t     BootProfiler::_readyUs = 0;
+portMUX_TYPE BootProfiler::_mux     = portMUX_INITIALIZER_UNLOCKED;
+
+int8_t BootProfiler::start(const char* name) {
+  const uint64_t now = Timebase::nowUs();
+  int8_t slot = -1;
+  portENTER_CRITICAL(&_mux);
+  if (_n < kMaxPhases) {
+    slot = (int8_t)_n++;
+    _ph[slot].name = name;
+    _ph[slot].t0   = now;
+    _ph[slot].t1   = 0;
+    _ph[slot].core = (int8_t)xPortGetCoreID();
+  }
+  portEXIT_CRITICAL(&_mux);
+  return slot;
+}
+
+void BootProfiler::end(int8_t slot) {
+  if (slot < 0) return;
+  _ph[slot].t1 = Timebase::nowUs();
+}
+
+void BootProfiler::markReady() {
+  if (_readyUs == 0) _readyUs = Timebase::nowUs();
+}
+
+void BootProfiler::print(Stream& s) {
+  s.printf("[BOOT] %u fases\n", (unsigned)_n);
+  s.printf("  %-16s %10s %10s %9s  core\n", "fase", "inicio ms", "fin ms", "dur ms");
+  for (uint8_t i=0;i<_n;i++) {
+    const Phase& p = _ph[i];
+    const uint64_t t1 = p.t1 ? p.t1 : p.t0;
+    s.printf("  %-16s %10.2f %10.2f %9.2f  %d%s\n", p.name,
+             (double)p.t0 * 1e-3, (double)t1 * 1e-3, (double)(t1 - p.t0) * 1e-3,
+             (int)p.core, p.t1 ? "" : "  (abierta)");
+  }
+  if (_readyUs) s.printf("[BOOT] listo para manejar en %.2f ms desde el encendido\n", (double)_readyUs * 1e-3);
+}
@@ -0,0 +1,49 @@
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <Arduino.h>
+#include "Timebase.h"
+
+// ============================================================
+// BootProfiler — Línea de tiempo del arranque
+// - Fases con nombre (inicio/fin en us desde el encendido, núcleo).
+// - Seguro entre tareas (fases en paralelo en ambos núcleos).
+// - markReady(): instante "listo para manejar"; print() muestra la tabla
+//   (fases solapadas en núcleos distintos = trabajo en paralelo).
+// - Tabla fija, sin heap. Los nombres deben ser literales.
+// ============================================================
+class BootProfiler {
+public:
+  static const uint8_t kMaxPhases = 24;
+
+  static int8_t start(const char* name);   // -1 si la tabla está llena
+  static void   end(int8_t slot);
+
+  // RAII: mide el bloque que la contiene
+  class Scope {
+  public:
+    explicit Scope(const char* name) : _slot(start(name)) {}
+    ~Scope() { end(_slot); }
+  private:
+    int8_t _slot;
+  };
+
+  static void     markReady();
+  static bool     ready()   { return _readyUs != 0; }
+  static uint64_t readyUs() { return _readyUs; }   // desde el encendido
+
+  static void print(Stream& s = Serial);
+
+private:
+  struct Phase {
+    const char* name;
+    uint64_t    t0, t1;
+    int8_t      core;
+  };
+  static Phase       _ph[kMaxPhases];
+  static uint8_t     _n;
+  static uint64_t    _readyUs;
+  static portMUX_TYPE _mux;
+};
+
+#endif // BOOT_PROFILER_H
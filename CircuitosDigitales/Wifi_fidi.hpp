@@ -1,6 +1,8 @@
 //Declarando funciones
 void wifi_init(char*_ssid, char*_pass);
 void wifi_ap_init(char*_ssid, char*_pass);
+void wifi_begin_async(char*_ssid, char*_pass);
+bool wifi_poll();
 
 // Wifi en modo estacion
 void wifi_init(char*_ssid, char*_pass){
@@ -49,4 +51,45 @@ void wifi_ap_init(char*_ssid, char*_pass){
   Serial.println(WiFi.softAPIP());
   Serial.println();  
   
-}
\ No newline at end of file
+}
+
+// Wifi en modo estacion sin bloquear: la asociacion corre mientras el resto
+// del sistema arranca. Llamar wifi_poll() en cada loop; mismo limite que
+// wifi_init (15 x 500 ms) antes de reiniciar.
+unsigned long wifi_async_t0 = 0;
+bool wifi_async_on = false;
+
+void wifi_begin_async(char*_ssid, char*_pass){
+  Serial.print("Conectando al AP");
+  Serial.print(_ssid);
+  Serial.println(" (async)");
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(_ssid,_pass);
+  wifi_async_t0 = millis();
+  wifi_async_on = true;
+  }
+
+bool wifi_poll(){
+  if(!wifi_async_on) return WiFi.status() == WL_CONNECTED;
+  if(WiFi.status() == WL_CONNECTED){
+    wifi_async_on = false;
+    #ifdef wifi_led
+      digitalWrite(wifi_led, 1);
+    #endif
+    Serial.print("Conectado en ");
+    Serial.print(millis() - wifi_async_t0);
+    Serial.println(" ms");
+    Serial.print("IP ->");
+    Serial.println(WiFi.localIP());
+    Serial.println();
+    return true;
+    }
+  if(millis() - wifi_async_t0 >= 15UL * 500UL){
+    wifi_async_on = false;
+    Serial.println("Error -> No se logro la conexion");
+    Serial.println("Reset en 3 segundos");
+    delay(3000);
+    ESP.restart();
+    }
+  return false;
+  }
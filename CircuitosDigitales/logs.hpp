@@ -1,42 +1,61 @@
-void Log(String s ="");
-void Logn(String s);
-void Logi(String s );
-void Loge(String s );
-void LogT(String s);
-void log_marq(String s);
+// Versiones const char*: imprimen por partes, sin String (sin heap)
+void Log(const char* s = "");
+void Logn(const char* s);
+void Logi(const char* s);
+void Loge(const char* s);
+void LogT(const char* s);
+void log_marq(const char* s);
+
+// Compatibilidad con String (delegan en las const char*, sin concatenar)
+void Log(const String& s);
+void Logn(const String& s);
+void Logi(const String& s);
+void Loge(const String& s);
+void LogT(const String& s);
+void log_marq(const String& s);
 
 //IMPRIME LOG
 
-void Log(String s ){Serial.print(s);}
+void Log(const char* s ){Serial.print(s);}
 
 //Imprime Nuevo renglon 
 
-void Logn(String s ){Serial.println(s);}
+void Logn(const char* s ){Serial.println(s);}
 
 //Imprime informacion
 
-void Logi(String s ){Serial.println("info -->"+ s);}
+void Logi(const char* s ){Serial.print("info -->"); Serial.println(s);}
 
 //IMPRIME ERROR
 
-void Loge(String s ){Serial.println("ERROR -->"+ s);}
+void Loge(const char* s ){Serial.print("ERROR -->"); Serial.println(s);}
 
 //IMPRIME TITULOS
 
-void LogT(String s ){s.toUpperCase();log_marq(s);}
+void LogT(const char* s ){
+  char up[64];
+  size_t n = 0;
+  for (; s[n] && n < sizeof(up) - 1; n++) up[n] = (char)toupper((unsigned char)s[n]);
+  up[n] = '\0';
+  log_marq(up);
+}
 
 //Marquesina 
-void log_marq(String s){
-  int tam=s.length();
-  String msg= "";
-  for(int ii=0; ii<tam+3; ii++)
-  msg=msg + '*';
-
-Serial.println();
-Serial.println(msg);
-Serial.println("* "+s+" *");
-Serial.println(msg);
-Serial.println();
-
-  
+void log_marq(const char* s){
+  const size_t tam = strlen(s);
+
+  Serial.println();
+  for (size_t ii=0; ii<tam+3; ii++) Serial.print('*');
+  Serial.println();
+  Serial.print("* "); Serial.print(s); Serial.println(" *");
+  for (size_t ii=0; ii<tam+3; ii++) Serial.print('*');
+  Serial.println();
+  Serial.println();
 }
+
+void Log(const String& s)      { Log(s.c_str()); }
+void Logn(const String& s)     { Logn(s.c_str()); }
+void Logi(const String& s)     { Logi(s.c_str()); }
+void Loge(const String& s)     { Loge(s.c_str()); }
+void LogT(const String& s)     { LogT(s.c_str()); }
+void log_marq(const String& s) { log_marq(s.c_str()); }
@@ -2,12 +2,64 @@
 
 #define DD_LOGF(fmt, ...) do { if (_log) _log->printf(fmt, ##__VA_ARGS__); } while(0)
 
+// Tarea de arranque: NVS de ambas ruedas en el otro núcleo mientras este
+// configura PCNT/LEDC. Pila y TCB estáticos (sin heap).
+static const uint32_t   kBootStackBytes = 4096;
+static StackType_t      s_bootStack[kBootStackBytes / sizeof(StackType_t)];
+static StaticTask_t     s_bootTcb;
+static StaticSemaphore_t s_bootDoneBuf;
+static SemaphoreHandle_t s_bootDone = nullptr;
+
+void DifferentialDrive::_bootNvsTask_(void* arg) {
+  DifferentialDrive* self = static_cast<DifferentialDrive*>(arg);
+  {
+    BootProfiler::Scope p("nvs R+L (task)");
+    self->_right.beginLoad();
+    self->_left.beginLoad();
+  }
+  xSemaphoreGive(s_bootDone);
+  vTaskDelete(nullptr);
+}
+
+bool DifferentialDrive::_bringUpParallel_() {
+  if (!s_bootDone) s_bootDone = xSemaphoreCreateBinaryStatic(&s_bootDoneBuf);
+  const BaseType_t core = (xPortGetCoreID() == 0) ? 1 : 0;
+  TaskHandle_t t = xTaskCreateStaticPinnedToCore(_bootNvsTask_, "ddBootNvs",
+                                                 sizeof(s_bootStack), this,
+                                                 uxTaskPriorityGet(nullptr),
+                                                 s_bootStack, &s_bootTcb, core);
+  if (!t) return false;   // sin tarea: el llamador hace el camino serial
+
+  { BootProfiler::Scope p("hw R+L"); _right.beginHardware(); _left.beginHardware(); }
+  {
+    BootProfiler::Scope p("join nvs");
+    xSemaphoreTake(s_bootDone, portMAX_DELAY);
+  }
+  return true;
+}
+
 DifferentialDrive::DifferentialDrive(const Config& cfg, Wheel& right, Wheel& left)
-: _cfg(cfg), _right(right), _left(left) {}
+: _cfg(cfg), _kin(cfg.wheelRadius, cfg.trackWidth), _right(right), _left(left) {}
 
 void DifferentialDrive::begin() {
-  _right.begin();
-  _left.begin();
+  if (_cfg.activeBrake) {
+    _right.setActiveBrake(true);
+    _left.setActiveBrake(true);
+  }
+  {
+    BootProfiler::Scope ph("dd.wheels");
+    if (!(_cfg.parallelBringUp && _bringUpParallel_())) {
+      { BootProfiler::Scope p("nvs R+L"); _right.beginLoad();     _left.beginLoad(); }
+      { BootProfiler::Scope p("hw R+L");  _right.beginHardware(); _left.beginHardware(); }
+    }
+    { BootProfiler::Scope p("finish R+L");  _right.beginFinish();   _left.beginFinish(); }
+  }
+
+  // A partir de aquí: sin heap (la memoria de runtime salió de StaticArena)
+  StaticArena::armHeapGuard();
+  DD_LOGF("[DD] arena %u/%u B | heap guard %s\n",
+          (unsigned)StaticArena::used(), (unsigned)StaticArena::capacity(),
+          STATIC_ARENA_HEAP_GUARD ? "ON" : "off (solo medida)");
 
   DD_LOGF("[DD] begin  r=%.4f L=%.4f  vMax=%.2f wMax=%.2f omgMax=%.2f\n",
           (double)_cfg.wheelRadius, (double)_cfg.trackWidth,
@@ -46,6 +98,16 @@ void DifferentialDrive::neutral() {
 }
 
 void DifferentialDrive::update(float dt_s) {
+  StaticArena::checkHeap("DD.update");
+
+  // Primer instante sin rutinas de arranque en curso = listo para manejar
+  if (!BootProfiler::ready() && !isCoordinatedRoutineRunning() &&
+      !_right.isAligning() && !_left.isAligning() &&
+      !_right.isCalibrating() && !_left.isCalibrating()) {
+    BootProfiler::markReady();
+    if (_log && _cfg.bootReport) BootProfiler::print(*_log);
+  }
+
   if (isCoordinatedRoutineRunning()) {
     _coordUpdate_(dt_s);
     return;
@@ -64,30 +126,59 @@ void DifferentialDrive::update(float dt_s) {
 
   _right.update(dt_s);
   _left.update (dt_s);
+
+  if (_cfg.odometry) _updateOdometry_();
+}
+
+// ----------------- Odometría -----------------
+
+void DifferentialDrive::resetOdometry(float x, float y, float theta) {
+  _odomX = x; _odomY = y; _odomTh = theta;
+  _odomPath = 0.0f;
+  _odomPulR = _right.pulses();
+  _odomPulL = _left.pulses();
+}
+
+// Pulsos nuevos desde el último paso (zero() del encoder reinicia el contador)
+static inline uint32_t _pulseDelta_(uint32_t now, uint32_t& last) {
+  const uint32_t d = (now >= last) ? (now - last) : now;
+  last = now;
+  return d;
+}
+
+void DifferentialDrive::_updateOdometry_() {
+  const float refR = _right.omegaRef(), refL = _left.omegaRef();
+  if (fabsf(refR) > _cfg.odomSignEps) _odomSgnR = (refR > 0.0f) ? +1 : -1;
+  if (fabsf(refL) > _cfg.odomSignEps) _odomSgnL = (refL > 0.0f) ? +1 : -1;
+
+  // Velocidad medida: omega acotada (decae sin pulsos en vez de quedarse congelada)
+  const float om[kin::Diff2::kWheels] = { _odomSgnR * _right.omegaBounded(),
+                                          _odomSgnL * _left.omegaBounded() };
+  float vy;
+  _kin.forward(om, _vMeas, vy, _wMeas);
+
+  // Pose: integra ángulo de rueda por pulsos contados, no omega × dt
+  const uint32_t nR = _pulseDelta_(_right.pulses(), _odomPulR);
+  const uint32_t nL = _pulseDelta_(_left.pulses(),  _odomPulL);
+  if (nR == 0 && nL == 0) return;
+  const float dphi[kin::Diff2::kWheels] = { _odomSgnR * (float)nR * _right.radPerPulse(),
+                                            _odomSgnL * (float)nL * _left.radPerPulse() };
+  float ds, dy, dth;
+  _kin.forward(dphi, ds, dy, dth);
+
+  // Punto medio (2º orden): rumbo a mitad del paso
+  const float thM = _odomTh + 0.5f * dth;
+  _odomX    += ds * cosf(thM);
+  _odomY    += ds * sinf(thM);
+  _odomTh   += dth;
+  _odomPath += fabsf(ds);
 }
 
 // ----------------- Helpers “normales” -----------------
 
 void DifferentialDrive::_applyLimitsAndRamps_(float dt) {
-  if (_cfg.vAccMax > 0.0f) {
-    const float dvMax = _cfg.vAccMax * dt;
-    const float dv = _vRef - _vCmd;
-    if (dv >  dvMax) _vCmd += dvMax;
-    else if (dv < -dvMax) _vCmd -= dvMax;
-    else _vCmd = _vRef;
-  } else {
-    _vCmd = _vRef;
-  }
-
-  if (_cfg.wAccMax > 0.0f) {
-    const float dwMax = _cfg.wAccMax * dt;
-    const float dw = _wRef - _wCmd;
-    if (dw >  dwMax) _wCmd += dwMax;
-    else if (dw < -dwMax) _wCmd -= dwMax;
-    else _wCmd = _wRef;
-  } else {
-    _wCmd = _wRef;
-  }
+  _vCmd = ramp::axis(_vRef, _vCmd, _cfg.vAccMax, _cfg.vDecMax, dt);
+  _wCmd = ramp::axis(_wRef, _wCmd, _cfg.wAccMax, _cfg.wDecMax, dt);
 
   if (_cfg.clampTwist) {
     _vCmd = _clamp(_vCmd, -_cfg.vMax, +_cfg.vMax);
@@ -95,13 +186,6 @@ void DifferentialDrive::_applyLimitsAndRamps_(float dt) {
   }
 }
 
-void DifferentialDrive::_computeWheelOmegasFromTwist_(float v, float w, float& wR, float& wL) const {
-  const float r = (_cfg.wheelRadius > 1e-9f) ? _cfg.wheelRadius : 1e-3f;
-  const float halfL = 0.5f * _cfg.trackWidth;
-  wR = (v + halfL*w) / r;
-  wL = (v - halfL*w) / r;
-}
-
 void DifferentialDrive::_maybeRescaleToWheelLimit_(float& v, float& w, float& wR, float& wL) const {
   const float aR = fabsf(wR), aL = fabsf(wL);
   const float aMax = (aR > aL) ? aR : aL;
@@ -142,6 +226,15 @@ bool DifferentialDrive::startCoordinatedCalibration(uint8_t lapsN, float w_assis
   return true;
 }
 
+bool DifferentialDrive::startCoordinatedBidirectional(uint8_t lapsN, float w_assist) {
+  if (isCoordinatedRoutineRunning()) return false;
+  if (lapsN == 0) return false;
+
+  if (w_assist <= 0.0f) w_assist = _cfg.calibAssistW;
+  _coordEnter_(CoordBiCalPos, lapsN, w_assist);
+  return true;
+}
+
 void DifferentialDrive::abortCoordinatedRoutine() {
   if (!isCoordinatedRoutineRunning()) return;
   _coordExit_();
@@ -173,6 +266,16 @@ void DifferentialDrive::_coordEnter_(CoordState st, uint8_t laps, float w_assist
       _left.startCalibration(_coordLaps);
       DD_LOGF("[DD] CALIB L start (%u laps) w=-%.3f\n", (unsigned)_coordLaps, (double)_coordW);
       break;
+    case CoordBiCalPos:
+    case CoordBiCalNeg:
+    case CoordBiAlignPos:
+      // Las rutinas de rueda se lanzan en _coordBiStep_ cuando el giro se estabiliza
+      _coordStarted = false;
+      _coordSettleT = 0.0f;
+      DD_LOGF("[DD] BI %s (%u laps) w=%c%.3f\n",
+              (_coordState==CoordBiAlignPos) ? "ALIGN" : "CALIB", (unsigned)_coordLaps,
+              (_coordState==CoordBiCalNeg) ? '-' : '+', (double)_coordW);
+      break;
     default: break;
   }
 }
@@ -181,6 +284,7 @@ void DifferentialDrive::_coordExit_() {
   _coordState = CoordIdle;
   _coordLaps  = 0;
   _coordW     = 0.0f;
+  _coordStarted = false;
   // detén giro
   _right.setOmegaRef(0.0f);
   _left.setOmegaRef (0.0f);
@@ -195,6 +299,9 @@ void DifferentialDrive::_coordUpdate_(float dt) {
     case CoordCalibR: wSpin = +_coordW; break; // derecha debe ir positiva (k++)
     case CoordAlignL:
     case CoordCalibL: wSpin = -_coordW; break; // izquierda positiva
+    case CoordBiCalPos:
+    case CoordBiAlignPos: wSpin = +_coordW; break; // R FWD, L REV
+    case CoordBiCalNeg:   wSpin = -_coordW; break; // R REV, L FWD
     default: break;
   }
 
@@ -235,16 +342,61 @@ void DifferentialDrive::_coordUpdate_(float dt) {
         _coordExit_();
       }
       break;
+    case CoordBiCalPos:
+      if (_coordBiStep_(dt, wSpin)) _coordEnter_(CoordBiCalNeg, _coordLaps, _coordW);
+      break;
+    case CoordBiCalNeg:
+      if (_coordBiStep_(dt, wSpin)) {
+        if (_cfg.biRealignLaps > 0) _coordEnter_(CoordBiAlignPos, _cfg.biRealignLaps, _coordW);
+        else { _coordExit_(); DD_LOGF("[DD] BI done\n"); }
+      }
+      break;
+    case CoordBiAlignPos:
+      if (_coordBiStep_(dt, wSpin)) { _coordExit_(); DD_LOGF("[DD] BI done\n"); }
+      break;
     default:
       _coordExit_();
       break;
   }
 }
 
+bool DifferentialDrive::_coordBiStep_(float dt, float wSpin) {
+  if (!_coordStarted) {
+    // Espera a que la rampa llegue al giro objetivo y se asiente (sin capturar transitorios)
+    if (fabsf(_wCmd - wSpin) > 1e-3f) { _coordSettleT = 0.0f; return false; }
+    _coordSettleT += dt;
+    if (_coordSettleT < _cfg.coordSettleS) return false;
+
+    // Sentido de cada rueda según el giro: w>0 -> R FWD, L REV
+    const int dirR = (wSpin >= 0.0f) ? +1 : -1;
+    const int dirL = -dirR;
+    bool okR, okL;
+    if (_coordState == CoordBiAlignPos) {
+      okR = _right.startAlignmentDir(_coordLaps, dirR);
+      okL = _left.startAlignmentDir (_coordLaps, dirL);
+    } else {
+      okR = _right.startCalibrationDir(_coordLaps, dirR);
+      okL = _left.startCalibrationDir (_coordLaps, dirL);
+    }
+    if (!okR && !okL) {
+      DD_LOGF("[DD] BI phase could not start -> exit\n");
+      _coordExit_();
+      return false;
+    }
+    _coordStarted = true;
+    return false;
+  }
+
+  // Fase terminada cuando ninguna rueda sigue en rutina
+  const bool busyR = _right.isCalibrating() || _right.isAligning();
+  const bool busyL = _left.isCalibrating()  || _left.isAligning();
+  return !busyR && !busyL;
+}
+
 // ----------------- Logging -----------------
 
 void DifferentialDrive::printDebugEvery(uint32_t periodMs) {
-  const uint32_t now = millis();
+  const uint32_t now = Timebase::nowMs();
   if (now - _dbgLastMs < periodMs) return;
   _dbgLastMs = now;
 
@@ -253,7 +405,10 @@ void DifferentialDrive::printDebugEvery(uint32_t periodMs) {
     (_coordState==CoordAlignR ) ? "A_R"   :
     (_coordState==CoordAlignL ) ? "A_L"   :
     (_coordState==CoordCalibR ) ? "C_R"   :
-    (_coordState==CoordCalibL ) ? "C_L"   : "?";
+    (_coordState==CoordCalibL ) ? "C_L"   :
+    (_coordState==CoordBiCalPos  ) ? "B_C+" :
+    (_coordState==CoordBiCalNeg  ) ? "B_C-" :
+    (_coordState==CoordBiAlignPos) ? "B_A+" : "?";
 
   if (_log) {
     _log->printf("[DD] state:%s  vRef:% .3f wRef:% .3f | vCmd:% .3f wCmd:% .3f | wR:% .3f wL:% .3f\n",
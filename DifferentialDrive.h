@@ -3,6 +3,13 @@
 
 #include <Arduino.h>
 #include "Wheel.h"
+#include "Kinematics.h"
+#include "Ramp.h"
+#include "StaticArena.h"
+#include "BootProfiler.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 
 // ============================================================
 // DifferentialDrive — Orquestador de 2 ruedas (R/L)
@@ -22,6 +29,11 @@ public:
     // --- Rampas ---
     float vAccMax = 1.5f;        // [m/s^2]  (0 => sin rampa)
     float wAccMax = 10.0f;       // [rad/s^2]
+    // Deceleración (|cmd| bajando hacia 0). 0 => igual que la aceleración.
+    // Valores > acc solo son alcanzables con freno activo en las ruedas.
+    float vDecMax = 0.0f;        // [m/s^2]
+    float wDecMax = 0.0f;        // [rad/s^2]
+    bool  activeBrake = false;   // propaga Wheel::Config::activeBrake en begin()
     bool  clampTwist = true;
 
     // --- Límite de omega de rueda ---
@@ -35,11 +47,27 @@ public:
 
     // --- (Opcional) Coordinated CALIB si la pides explícitamente ---
     float   calibAssistW               = 2.0f;  // [rad/s]
+
+    // --- Rutina bidireccional (CAL FWD+REV en ambas ruedas) ---
+    uint8_t biRealignLaps              = 2;     // re-alineación final tras invertir (0 = omitir)
+    float   coordSettleS               = 0.30f; // [s] espera tras la rampa antes de capturar
+
+    // --- Arranque ---
+    bool    parallelBringUp            = true;  // NVS (otro núcleo) en paralelo con PCNT/LEDC
+    bool    bootReport                 = true;  // imprime BootProfiler al quedar listo
+
+    // --- Odometría ---
+    // Encoders de un canal (magnitud): el signo de cada rueda se toma de su
+    // última referencia no nula (sigue valiendo mientras frena por inercia).
+    // La pose integra pulsos contados (Δpulses × 2π/PPR); vMeas/wMeas usan omega acotada.
+    bool    odometry                   = true;
+    float   odomSignEps                = 0.05f; // [rad/s] |omegaRef| mínima para fijar signo
   };
 
   DifferentialDrive(const Config& cfg, Wheel& right, Wheel& left);
 
-  // Inicializa (propaga begin() a ruedas) y lanza alineación coordinada si procede
+  // Inicializa ruedas por fases (NVS en paralelo con PCNT/LEDC si parallelBringUp)
+  // y lanza alineación coordinada si procede. Fases en BootProfiler.
   void begin();
 
   // --- Comandos de alto nivel (cuando NO hay coordinación en curso) ---
@@ -57,10 +85,20 @@ public:
   float wCmd() const { return _wCmd; }
   float omegaR() const { return _omegaR_cmd; }
   float omegaL() const { return _omegaL_cmd; }
+  // Robot en reposo: sin twist, sin rutina y ruedas quietas (p.ej. para PowerManager)
+  bool  isIdle(float wEps = 0.05f) const {
+    return !isCoordinatedRoutineRunning() && _vRef == 0.0f && _wRef == 0.0f &&
+           _vCmd == 0.0f && _wCmd == 0.0f &&
+           _right.omega() < wEps && _left.omega() < wEps;
+  }
 
   // --- Rutinas coordinadas ---
   bool startCoordinatedAlignment(uint8_t lapsN, float w_assist_radps = 0.0f);
   bool startCoordinatedCalibration(uint8_t lapsN, float w_assist_radps = 0.0f);
+  // Calibra las 4 LUT (R/L x FWD/REV) en dos giros en sitio opuestos:
+  //   w>0: R FWD + L REV a la vez;  w<0: R REV + L FWD a la vez;
+  // luego re-alinea (w>0) los sentidos del primer giro tras la inversión.
+  bool startCoordinatedBidirectional(uint8_t lapsN, float w_assist_radps = 0.0f);
   void abortCoordinatedRoutine();
   bool isCoordinatedRoutineRunning() const { return _coordState != CoordIdle; }
 
@@ -71,6 +109,15 @@ public:
   bool startAlignmentL (uint8_t N)  { return _left.startAlignment(N); }
 
   // Logging
+  // Odometría (marco del mundo fijado en resetOdometry)
+  void  resetOdometry(float x = 0.0f, float y = 0.0f, float theta = 0.0f);
+  float odomX()     const { return _odomX; }       // [m]
+  float odomY()     const { return _odomY; }       // [m]
+  float odomTheta() const { return _odomTh; }      // [rad] acumulado (sin envolver)
+  float odomPath()  const { return _odomPath; }    // [m] longitud recorrida
+  float vMeas()     const { return _vMeas; }       // [m/s] desde encoders
+  float wMeas()     const { return _wMeas; }       // [rad/s] desde encoders
+
   void setLog(Stream* s) { _log = s; }
   void printDebugEvery(uint32_t periodMs = 200);
 
@@ -81,20 +128,33 @@ public:
 private:
   // ---------- helpers “normales” del drive ----------
   void  _applyLimitsAndRamps_(float dt);
-  void  _computeWheelOmegasFromTwist_(float v, float w, float& wR, float& wL) const;
+  inline void _computeWheelOmegasFromTwist_(float v, float w, float& wR, float& wL) const {
+    float om[kin::Diff2::kWheels];
+    _kin.inverse(v, 0.0f, w, om);   // geometría invertida en el constructor
+    wR = om[0]; wL = om[1];
+  }
   void  _maybeRescaleToWheelLimit_(float& v, float& w, float& wR, float& wL) const;
   static inline float _clamp(float x, float a, float b) {
     return (x < a) ? a : (x > b) ? b : x;
   }
 
+  void  _updateOdometry_();
+
+  // ---------- arranque ----------
+  bool _bringUpParallel_();                 // false -> no se pudo crear la tarea
+  static void _bootNvsTask_(void* arg);
+
   // ---------- coordinación ----------
-  enum CoordState { CoordIdle, CoordAlignR, CoordAlignL, CoordCalibR, CoordCalibL };
+  enum CoordState { CoordIdle, CoordAlignR, CoordAlignL, CoordCalibR, CoordCalibL,
+                    CoordBiCalPos, CoordBiCalNeg, CoordBiAlignPos };
   void _coordUpdate_(float dt);
   void _coordEnter_(CoordState st, uint8_t laps, float w_assist);
   void _coordExit_();
+  bool _coordBiStep_(float dt, float wSpin);   // fases bidireccionales; true = fase terminada
 
 private:
   Config _cfg;
+  kin::Diff2 _kin;   // [0]=R, [1]=L
   Wheel& _right;
   Wheel& _left;
 
@@ -111,6 +171,14 @@ private:
   CoordState _coordState = CoordIdle;
   uint8_t    _coordLaps  = 0;
   float      _coordW     = 0.0f;   // [rad/s] giro en sitio durante rutina
+  bool       _coordStarted = false; // fase bidireccional: rutinas de rueda lanzadas
+  float      _coordSettleT = 0.0f;  // [s] tiempo a velocidad de giro estable
+
+  // Odometría
+  float  _odomX = 0.0f, _odomY = 0.0f, _odomTh = 0.0f, _odomPath = 0.0f;
+  float  _vMeas = 0.0f, _wMeas = 0.0f;
+  int8_t _odomSgnR = +1, _odomSgnL = +1;
+  uint32_t _odomPulR = 0, _odomPulL = 0;   // pulses() de cada rueda en el paso anterior
 
   // Logging
   Stream*   _log = nullptr;
@@ -1,5 +1,9 @@
 #include "EncoderPCNT.h"
 #include "SectorCalibrator.h"
+#include "SpeedEstimators.h"
+#include "esp_intr_alloc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 // Macro de log local
 #define ENC_LOGF(fmt, ...) do { if (_log) _log->printf(fmt, ##__VA_ARGS__); } while(0)
@@ -10,43 +14,72 @@
 EncoderPCNT::EncoderPCNT(const Config& cfg)
 : _cfg(cfg),
   _ppr(max(1, cfg.pulsesPerRev))
-{}
+{
+  _revLen = (uint16_t)min(_ppr, (int)kRevRingMax);
+  _clearRevRing();
+  clearLatencyHistogram();
+}
 
 void EncoderPCNT::begin() {
   pinMode(_cfg.pin, INPUT_PULLUP);
-  _setupPCNT();                // PCNT + filtro HW + evento por pulso
-  _lastSeenMs  = millis();
+  _setupPCNT();                // PCNT + filtro HW (+ evento por pulso si no hay captura)
+  _installIsrs();              // ISR de PCNT o captura, en el núcleo elegido
+  _lastSeenUs  = Timebase::nowUs();
   _periodEmaUs = 0.0f;
   _rpm = _omega = 0.0f;
 }
 
 void EncoderPCNT::update(float /*dt_s*/) {
   // Snapshot atómico de variables compartidas con ISR
-  uint32_t cntSnap, perSnap, lastUsSnap;
+  uint32_t cntSnap, perSnap;
+  uint64_t lastUsSnap;
   portENTER_CRITICAL(&_mux);
   cntSnap     = _isrCount;
   perSnap     = _isrPeriodUs;
   lastUsSnap  = _isrLastUs;
   portEXIT_CRITICAL(&_mux);
 
-  static uint32_t lastConsumed = 0;
-  if (cntSnap == lastConsumed) {
+  const uint64_t nowUs = Timebase::nowUs();
+  if (_est) _est->onTick(nowUs);
+
+  if (cntSnap == _lastConsumed) {
     // Timeout: si pasó demasiado tiempo sin pulsos, baja a cero
-    if (millis() - _lastSeenMs > _cfg.timeoutStopMs) {
+    if (nowUs - _lastSeenUs > (uint64_t)_cfg.timeoutStopMs * 1000ULL) {
       _rpm = 0.0f; _omega = 0.0f; _periodEmaUs = 0.0f;
+      _clearRevRing();
     }
     return;
   }
 
   // Consume nuevos pulsos
-  uint32_t delta = cntSnap - lastConsumed;
-  lastConsumed = cntSnap;
+  uint32_t delta = cntSnap - _lastConsumed;
+  _lastConsumed = cntSnap;
 
   // Si delta > 1 no tenemos cola de periodos; usamos el último válido (simple).
+  _pulseTsUs = lastUsSnap;
   for (uint32_t i = 0; i < delta; ++i) {
     if (perSnap == 0) continue; // ignora primer pulso tras arranque
     _applyPeriodAndCompute(perSnap);
   }
+
+  if (perSnap != 0) {
+    _lastSampleUs = lastUsSnap;
+    _sampleSeq++;
+  }
+}
+
+float EncoderPCNT::omegaBounded(uint64_t nowUs) const {
+  if (_lastSampleUs == 0 || nowUs <= _lastSampleUs) return _omega;
+  const uint64_t since = nowUs - _lastSampleUs;
+  const float bound = 2.0f * PI * 1.0e6f / (static_cast<float>(_ppr) * (float)since);
+  return (bound < _omega) ? bound : _omega;
+}
+
+float EncoderPCNT::omegaRev() const {
+  if (!omegaRevValid() || _revSumUs == 0) return 0.0f;
+  // _revLen periodos = _revLen/PPR vueltas
+  const float rev_per_s = 1.0e6f * (float)_revLen / ((float)_ppr * (float)_revSumUs);
+  return 2.0f * PI * rev_per_s;
 }
 
 void EncoderPCNT::zero() {
@@ -54,8 +87,12 @@ void EncoderPCNT::zero() {
   _isrCount = 0;
   _isrPeriodUs = 0;
   _isrLastUs = 0;
+  _capPrimed = false;
   portEXIT_CRITICAL(&_mux);
 
+  _lastConsumed = 0;
+  _lastSampleUs = 0;
+  _clearRevRing();
   _totalCount = 0;
   _periodEmaUs = 0.0f;
   _rpm = _omega = 0.0f;
@@ -67,7 +104,7 @@ void EncoderPCNT::zero() {
 }
 
 void EncoderPCNT::printDebugEvery(uint32_t periodMs) {
-  const uint32_t now = millis();
+  const uint32_t now = Timebase::nowMs();
   if (now - _dbgLastMs < periodMs) return;
 
   // snapshot atómico del contador de ISR
@@ -96,24 +133,66 @@ void EncoderPCNT::printDebugEvery(uint32_t periodMs) {
 // =======================
 //  Privado (ISR y helpers)
 // =======================
+// Todo el camino del pulso (ISR -> _onPulseIsr) está en IRAM y solo usa funciones
+// IRAM-safe (Timebase::nowUs -> esp_timer_get_time, portENTER_CRITICAL_ISR): sigue funcionando con la
+// caché de flash deshabilitada (escrituras NVS, ráfagas WiFi).
 void IRAM_ATTR EncoderPCNT::_pcnt_isr(void* arg) {
   auto* self = static_cast<EncoderPCNT*>(arg);
-  const uint32_t now = micros();
-  self->_onPulseIsr(now);
-  // Rearmar umbral para que cada 1 vuelva a disparar
-  pcnt_counter_clear(self->_cfg.unit);
+  self->_onPulseIsr(Timebase::nowUs());
+  // Sin pcnt_counter_clear(): el contador se auto-resetea en h_lim=1 (ver _setupPCNT)
+}
+
+bool IRAM_ATTR EncoderPCNT::_cap_isr(mcpwm_unit_t /*unit*/, mcpwm_capture_channel_id_t /*ch*/,
+                                     const cap_event_data_t* ev, void* arg) {
+  auto* self = static_cast<EncoderPCNT*>(arg);
+  self->_onCaptureIsr(ev->cap_value);   // valor del timer latcheado en el flanco
+  return false;                         // no despierta tareas
+}
+
+void IRAM_ATTR EncoderPCNT::_onCaptureIsr(uint32_t ticks) {
+  // Convierte ticks APB a una línea de tiempo en us sin perder el resto.
+  // El reloj de sistema solo sirve para detectar huecos mayores que la vuelta del contador.
+  const uint64_t coarseUs = Timebase::nowUs();
+  if (_capPrimed && (coarseUs - _capLastCoarse) < kCapWrapGuardUs) {
+    _capFrac += ticks - _capLastTicks;
+    _capUs   += _capFrac / kCapTicksPerUs;
+    _capFrac %= kCapTicksPerUs;
+  } else {
+    // Primer flanco o hueco largo: re-ancla al reloj de sistema
+    _capUs     = coarseUs;
+    _capFrac   = 0;
+    _capPrimed = true;
+  }
+  _capLastTicks  = ticks;
+  _capLastCoarse = coarseUs;
+
+  // Latencia de entrada = (ahora - flanco HW) menos el mínimo observado (el ancla
+  // de la línea de tiempo incluye una latencia desconocida pero constante)
+  if (_cfg.latencyHistogram) {
+    const int32_t off = (int32_t)(coarseUs - _capUs);
+    if (!_latPrimed || off < _latMinOffUs) { _latMinOffUs = off; _latPrimed = true; }
+    const uint32_t lat = (uint32_t)(off - _latMinOffUs);
+    uint32_t bin = lat / (_cfg.latBinUs ? _cfg.latBinUs : 1);
+    if (bin >= kLatBins) bin = kLatBins - 1;
+    _latHist[bin]++;
+    if (lat > _latMaxUs) _latMaxUs = lat;
+  }
+
+  _onPulseIsr(_capUs);
 }
 
-void IRAM_ATTR EncoderPCNT::_onPulseIsr(uint32_t nowUs) {
+void IRAM_ATTR EncoderPCNT::_onPulseIsr(uint64_t nowUs) {
   // Ventana lógica (MIN GAP)
   if (_cfg.minGapUs > 0) {
-    const uint32_t gap = nowUs - _isrLastUs;
+    const uint64_t gap = nowUs - _isrLastUs;
     if (_isrLastUs != 0 && gap < _cfg.minGapUs) {
       return; // rebote/ruido
     }
   }
 
-  const uint32_t period = (_isrLastUs == 0) ? 0 : (nowUs - _isrLastUs);
+  // Periodo en 64 bits (sin vuelta de micros() a ~71 min); se satura a 32 bits
+  const uint64_t p64 = (_isrLastUs == 0) ? 0 : (nowUs - _isrLastUs);
+  const uint32_t period = (p64 > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)p64;
 
   portENTER_CRITICAL_ISR(&_mux);
   _isrLastUs = nowUs;
@@ -137,7 +216,9 @@ void EncoderPCNT::_setupPCNT() {
   }
   c.lctrl_mode = PCNT_MODE_KEEP;
   c.hctrl_mode = PCNT_MODE_KEEP;
-  c.counter_h_lim = 32767;
+  // h_lim=1: el HW resetea el contador en cada pulso y dispara H_LIM, así la ISR
+  // no necesita pcnt_counter_clear() (no es IRAM-safe en el driver legacy)
+  c.counter_h_lim = 1;
   c.counter_l_lim = 0;
   c.unit    = _cfg.unit;
   c.channel = _cfg.channel;
@@ -151,27 +232,165 @@ void EncoderPCNT::_setupPCNT() {
     pcnt_filter_disable(_cfg.unit);
   }
 
-  // Evento por pulso: THRES_0=1
-  ESP_ERROR_CHECK(pcnt_set_event_value(_cfg.unit, PCNT_EVT_THRES_0, 1));
-  ESP_ERROR_CHECK(pcnt_event_enable(_cfg.unit, PCNT_EVT_THRES_0));
-
   // Preparar y arrancar
   ESP_ERROR_CHECK(pcnt_counter_pause(_cfg.unit));
   ESP_ERROR_CHECK(pcnt_counter_clear(_cfg.unit));
   ESP_ERROR_CHECK(pcnt_counter_resume(_cfg.unit));
 
-  // Instalar ISR y registrar handler con "this" como arg
+  // Con captura HW el timestamp lo da MCPWM: PCNT solo cuenta, sin ISR
+  if (_cfg.tsSource == TimestampSource::McpwmCapture) return;
+
+  // Evento por pulso: H_LIM (contador llega a 1 y vuelve a 0 por HW)
+  ESP_ERROR_CHECK(pcnt_event_enable(_cfg.unit, PCNT_EVT_H_LIM));
+}
+
+namespace {
+struct IsrInstallJob {
+  EncoderPCNT* self;
+  TaskHandle_t parent;
+};
+}
+
+void EncoderPCNT::_installTask(void* arg) {
+  auto* job = static_cast<IsrInstallJob*>(arg);
+  _installIsrsOnCore(job->self);
+  xTaskNotifyGive(job->parent);
+  vTaskDelete(nullptr);
+}
+
+void EncoderPCNT::_installIsrs() {
+  // La CPU que reserva la interrupción es la que la atiende: si se pide otro
+  // núcleo, la instalación corre en una tarea corta fijada allí y se espera
+  // (IPC no vale: su tarea tiene poca pila y no admite llamadas que bloqueen).
+  bool pinned = false;
+  if (_cfg.isrCore >= 0 && _cfg.isrCore != (int8_t)xPortGetCoreID()) {
+    IsrInstallJob job = { this, xTaskGetCurrentTaskHandle() };
+    if (xTaskCreatePinnedToCore(&EncoderPCNT::_installTask, "encIsrInst", 3072, &job,
+                                uxTaskPriorityGet(nullptr), nullptr,
+                                (BaseType_t)_cfg.isrCore) == pdPASS) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);   // join
+      pinned = true;
+    } else {
+      ENC_LOGF("[ENC] no task for core %d, ISR stays on core %d\n",
+               (int)_cfg.isrCore, (int)xPortGetCoreID());
+    }
+  }
+  if (!pinned) _installIsrsOnCore(this);
+
+  // Log ya en la tarea que llama (no desde la tarea de instalación)
+  if (_cfg.tsSource == TimestampSource::McpwmCapture) {
+    ENC_LOGF("[ENC] HW capture: MCPWM%u CAP%u on GPIO%d (core %d)\n",
+             (unsigned)_cfg.capUnit, (unsigned)_cfg.capChannel, (int)_cfg.pin,
+             pinned ? (int)_cfg.isrCore : (int)xPortGetCoreID());
+    if (_cfg.isrLevel != 1)
+      ENC_LOGF("[ENC] isrLevel=%u ignored: MCPWM capture ISR is fixed at level 1\n",
+               (unsigned)_cfg.isrLevel);
+  }
+}
+
+void EncoderPCNT::_installIsrsOnCore(void* arg) {
+  auto* self = static_cast<EncoderPCNT*>(arg);
+
+  if (self->_cfg.tsSource == TimestampSource::McpwmCapture) {
+    self->_setupCapture();
+    return;
+  }
+
+  // Servicio ISR de PCNT: en IRAM y al nivel pedido (compartido por todas las unidades)
   static bool isrInstalled = false;
   if (!isrInstalled) {
-    ESP_ERROR_CHECK(pcnt_isr_service_install(0)); // ISR en IRAM
+    const uint8_t lvl = (self->_cfg.isrLevel >= 1 && self->_cfg.isrLevel <= 3) ? self->_cfg.isrLevel : 1;
+    const int flags = ESP_INTR_FLAG_IRAM | (ESP_INTR_FLAG_LEVEL1 << (lvl - 1));
+    ESP_ERROR_CHECK(pcnt_isr_service_install(flags));
     isrInstalled = true;
   }
-  ESP_ERROR_CHECK(pcnt_isr_handler_add(_cfg.unit, &EncoderPCNT::_pcnt_isr, this));
+  ESP_ERROR_CHECK(pcnt_isr_handler_add(self->_cfg.unit, &EncoderPCNT::_pcnt_isr, self));
+}
+
+void EncoderPCNT::_setupCapture() {
+  // El mismo GPIO alimenta PCNT y MCPWM CAPx (la matriz de entrada admite varios destinos)
+  const mcpwm_io_signals_t sig = (mcpwm_io_signals_t)(MCPWM_CAP_0 + _cfg.capChannel);
+  ESP_ERROR_CHECK(mcpwm_gpio_init(_cfg.capUnit, sig, _cfg.pin));
+
+  mcpwm_capture_config_t cc = {};
+  cc.cap_edge     = _cfg.countRising ? MCPWM_POS_EDGE : MCPWM_NEG_EDGE;
+  cc.cap_prescale = 1;                      // 80 MHz -> 12.5 ns de resolución
+  cc.capture_cb   = &EncoderPCNT::_cap_isr;
+  cc.user_data    = this;
+  // El driver registra su ISR con ESP_INTR_FLAG_IRAM fijo (nivel 1): isrLevel no aplica
+  ESP_ERROR_CHECK(mcpwm_capture_enable_channel(_cfg.capUnit,
+                  (mcpwm_capture_channel_id_t)_cfg.capChannel, &cc));
+}
+
+void EncoderPCNT::clearLatencyHistogram() {
+  portENTER_CRITICAL(&_mux);
+  for (uint8_t i=0;i<kLatBins;i++) _latHist[i] = 0;
+  _latMaxUs  = 0;
+  _latPrimed = false;
+  portEXIT_CRITICAL(&_mux);
+}
+
+void EncoderPCNT::printLatencyHistogram(Stream& s) const {
+  if (!_cfg.latencyHistogram || _cfg.tsSource != TimestampSource::McpwmCapture) {
+    s.println("[ENC] latency histogram off (needs latencyHistogram + McpwmCapture)");
+    return;
+  }
+  const unsigned w = _cfg.latBinUs ? _cfg.latBinUs : 1;
+  s.printf("[ENC] ISR entry latency (rel. best case), max=%lu us\n", (unsigned long)_latMaxUs);
+  for (uint8_t i=0;i<kLatBins;i++) {
+    if (i < kLatBins-1) s.printf("  [%3u..%3u) us: %lu\n", i*w, (i+1)*w, (unsigned long)_latHist[i]);
+    else                s.printf("  [%3u..   ) us: %lu\n", i*w, (unsigned long)_latHist[i]);
+  }
+}
+
+void EncoderPCNT::_pushRevPeriod(uint32_t dt_us) {
+  if (_revFill >= _revLen) _revSumUs -= _revBuf[_revHead];
+  else                     _revFill++;
+  _revBuf[_revHead] = dt_us;
+  _revSumUs += dt_us;
+  _revHead = (uint16_t)((_revHead + 1) % _revLen);
+}
+
+void EncoderPCNT::_clearRevRing() {
+  _revHead = _revFill = 0;
+  _revSumUs = 0;
+  _dirConf  = 0.0f;
+  _dirAgree = 0;
+}
+
+void EncoderPCNT::_inferDirection() {
+  if (_revFill < _revLen) return;
+
+  // Anillo en orden temporal (antiguo -> reciente); _revHead apunta al más antiguo
+  uint32_t win[kRevRingMax];
+  for (uint16_t i=0;i<_revLen;i++) win[i] = _revBuf[(_revHead + i) % _revLen];
+
+  int8_t d; float conf;
+  if (!_cal->inferDirection(win, _revLen, d, conf)) { _dirConf = 0.0f; return; }
+  _dirInferred = d;
+  _dirConf     = conf;
+
+  if (conf < _cfg.dirConfMin) { _dirAgree = 0; return; }
+  if (d != _dirCandidate) { _dirCandidate = d; _dirAgree = 0; }
+  if (_dirAgree < 255) _dirAgree++;
+
+  if (_dirAgree >= _cfg.dirConfirmN && d != _stepDir) {
+    _stepDir = d;
+    ENC_LOGF("[ENC] stepDir from pattern = %+d (conf=%.2f)\n", (int)d, (double)conf);
+  }
 }
 
 void EncoderPCNT::_applyPeriodAndCompute(uint32_t dt_us) {
   float dt = (float)dt_us;
 
+  // 0) Anillo de una vuelta con el periodo crudo (antes de LUT)
+  _pushRevPeriod(dt_us);
+
+  // 0b) Dirección por patrón (fuera de cal/align: ahí el sentido lo fija la rutina)
+  if (_cfg.inferDirection && _cal && !_cal->isCalibrating() && !_cal->isAligning()) {
+    _inferDirection();
+  }
+
   // 1) Integración con calibrador (dual LUT)
   if (_cal) {
     // Alimentar buffers en cal/align y gestionar cierres
@@ -214,7 +433,16 @@ void EncoderPCNT::_applyPeriodAndCompute(uint32_t dt_us) {
     if (_cfg.invert) { rpm = -rpm; omega = -omega; }
     _rpm   = fabsf(rpm);
     _omega = fabsf(omega);
-    _lastSeenMs = millis();
+
+    // Estimadores en sombra: mismo periodo corregido; la ranura activa (si hay) manda
+    if (_est) {
+      _est->onPulse(dt, _pulseTsUs, _omega);
+      if (_est->hasActive()) {
+        _omega = _est->activeOmega();
+        _rpm   = _omega * (60.0f / (2.0f * PI));
+      }
+    }
+    _lastSeenUs = Timebase::nowUs();
     _totalCount += 1; // SW (por pulso)
   }
 
@@ -3,9 +3,13 @@
 
 #include <Arduino.h>
 #include "driver/pcnt.h"
+#include "driver/mcpwm.h"
+#include "esp_timer.h"
+#include "Timebase.h"
 
 // Forward declaration
 class SectorCalibrator;
+class SpeedEstimators;
 
 // ==============================
 //  EncoderPCNT (KY-003 1 canal)
@@ -14,9 +18,24 @@ class SectorCalibrator;
 //  - Estima RPM y rad/s con EMA del periodo
 //  - Índice de sector con dirección (+1/-1) para casar LUT por sentido
 //  - Integra calibración/alineación por sectores via SectorCalibrator (dual LUT)
+//  - Timestamp del flanco (Timebase, 64 bits): reloj en la ISR de PCNT, o captura HW (MCPWM)
+//    que latchea el timer APB en el flanco (inmune a la latencia de ISR)
+//  - Camino de pulso en IRAM (sin caché de flash): ISR a nivel/núcleo elegibles
+//    e histograma opcional de latencia de entrada a ISR (con captura HW)
+//  - Dirección inferida del patrón de imanes (opcional, sin segundo sensor)
+//  - Banco de estimadores en sombra (opcional, SpeedEstimators)
 // ==============================
 class EncoderPCNT {
 public:
+  static const uint16_t kRevRingMax = 64;   // máx. PPR soportado por el anillo de una vuelta
+  static const uint8_t  kLatBins    = 16;   // bins del histograma de latencia (el último acumula)
+
+  // Origen del timestamp de cada pulso
+  enum class TimestampSource : uint8_t {
+    IsrMicros    = 0,   // Timebase::nowUs() al entrar a la ISR de PCNT (incluye latencia de ISR)
+    McpwmCapture = 1    // captura HW del flanco (MCPWM CAPx, timer APB 80 MHz)
+  };
+
   struct Config {
     gpio_num_t     pin;              // GPIO del KY-003 (open collector + pull-up)
     pcnt_unit_t    unit;             // PCNT_UNIT_0..PCNT_UNIT_7
@@ -28,6 +47,29 @@ public:
     uint32_t       minGapUs = 0;        // ventana lógica adicional (us), p.ej. 500
     float          alphaPeriod = 1.0f;  // EMA del período [0..1) 1 sin filtro, 0 retardo infinito
     uint32_t       timeoutStopMs = 2000;// declara 0 rpm si no hay pulsos (ms)
+
+    // Captura HW (tsSource = McpwmCapture). PCNT sigue contando; la ISR la da la captura.
+    // Nota: la captura no tiene filtro glitch -> usa minGapUs para rebotes.
+    TimestampSource tsSource  = TimestampSource::IsrMicros;
+    mcpwm_unit_t    capUnit   = MCPWM_UNIT_0;
+    uint8_t         capChannel = 0;     // 0..2 -> MCPWM_CAP_0..2 (uno por encoder)
+
+    // ISR: nivel (1..3) y núcleo (-1 = el que llama a begin()). El servicio ISR de PCNT
+    // es compartido por todas las unidades: manda la config del primer encoder.
+    // isrLevel solo aplica a PCNT: la ISR de captura MCPWM la fija el driver (nivel 1).
+    uint8_t         isrLevel  = 1;
+    int8_t          isrCore   = -1;
+
+    // Histograma de latencia de entrada a ISR (solo con McpwmCapture: requiere el
+    // instante HW del flanco). Latencia relativa al mejor caso observado.
+    bool            latencyHistogram = false;
+    uint16_t        latBinUs         = 2;   // ancho de bin [us]
+
+    // Dirección por correlación con el patrón (requiere calibrador con patrón listo).
+    // Con confianza >= dirConfMin en dirConfirmN pulsos seguidos fija _stepDir.
+    bool            inferDirection   = false;
+    float           dirConfMin       = 0.30f;
+    uint8_t         dirConfirmN      = 3;
   };
 
   explicit EncoderPCNT(const Config& cfg);
@@ -42,7 +84,26 @@ public:
   float rpm()   const { return _rpm; }          // RPM actuales (suavizadas)
   float omega() const { return _omega; }        // rad/s (≥0; magnitud)
   long  count() const { return _totalCount; }   // ticks SW acumulados
-  uint32_t lastSeenMs() const { return _lastSeenMs; }
+  // Pulsos HW consumidos por update() (incluye el primero tras arranque; sin signo).
+  // Para odometría: delta entre llamadas × radPerPulse(). zero() lo vuelve a 0.
+  uint32_t pulses()      const { return _lastConsumed; }
+  float    radPerPulse() const { return 2.0f * PI / (float)_ppr; }
+  uint32_t lastSeenMs() const { return (uint32_t)(_lastSeenUs / 1000ULL); }
+
+  // Muestras nuevas (para control sincronizado a pulsos)
+  // sampleSeq() se incrementa en cada update() que consumió >=1 periodo válido;
+  // lastSampleUs() es el timestamp (Timebase) del último pulso consumido.
+  uint32_t sampleSeq()    const { return _sampleSeq; }
+  uint64_t lastSampleUs() const { return _lastSampleUs; }
+
+  // Cota superior de |omega| si no llega pulso desde lastSampleUs():
+  // w <= 2*PI / (PPR * (nowUs - lastSampleUs)). Devuelve omega() si es menor.
+  float omegaBounded(uint64_t nowUs) const;
+
+  // Velocidad por vuelta completa: suma de los últimos PPR periodos CRUDOS (sin LUT).
+  // Inmune al error de colocación de imanes; válida cuando ya hay una vuelta en el anillo.
+  bool  omegaRevValid() const { return _revFill >= _revLen; }
+  float omegaRev()      const;
 
   // Sector actual y dirección de indexado
   void     setSectorIdx(uint16_t k) { _sectorIdx = (k % _ppr); }
@@ -52,25 +113,50 @@ public:
   void  setStepDirection(int dir) { _stepDir = (dir >= 0) ? +1 : -1; }
   int   stepDirection() const { return _stepDir; }
 
+  // Dirección inferida del patrón (ver Config::inferDirection)
+  bool   directionLocked()    const { return _cfg.inferDirection && _dirConf >= _cfg.dirConfMin; }
+  int8_t inferredDirection()  const { return _dirInferred; }
+  float  directionConfidence()const { return _dirConf; }
+
   // Integración con calibrador/LUT
   void attachCalibrator(SectorCalibrator* cal) { _cal = cal; }
 
+  // Estimadores en paralelo: todos ven los mismos pulsos; si el banco tiene una
+  // ranura activa, su w sustituye al EMA propio en omega()/rpm()
+  void attachEstimators(SpeedEstimators* est) { _est = est; }
+
   // Utilidades
   void zero();                    // borra contador SW y HW
   void setInvert(bool inv) { _cfg.invert = inv; }
   void printDebugEvery(uint32_t periodMs = 200);
 
+  // Histograma de latencia de ISR (ver Config::latencyHistogram)
+  void     clearLatencyHistogram();
+  uint32_t latencyBin(uint8_t i) const { return (i < kLatBins) ? _latHist[i] : 0; }
+  uint32_t latencyMaxUs() const { return _latMaxUs; }
+  void     printLatencyHistogram(Stream& s = Serial) const;
+
   // Logging opcional
   void setLog(Stream* s) { _log = s; }
 
 private:
   // ---- ISR ----
   static void IRAM_ATTR _pcnt_isr(void* arg);
-  void IRAM_ATTR _onPulseIsr(uint32_t nowUs);
+  static bool IRAM_ATTR _cap_isr(mcpwm_unit_t unit, mcpwm_capture_channel_id_t ch,
+                                 const cap_event_data_t* ev, void* arg);
+  void IRAM_ATTR _onCaptureIsr(uint32_t ticks);
+  void IRAM_ATTR _onPulseIsr(uint64_t nowUs);
 
   // ---- Helpers ----
   void _setupPCNT();
+  void _setupCapture();
+  void _installIsrs();                 // PCNT/captura en el núcleo configurado
+  static void _installIsrsOnCore(void* arg);
+  static void _installTask(void* arg);  // tarea corta fijada a isrCore (ver _installIsrs)
   void _applyPeriodAndCompute(uint32_t dt_us);
+  void _pushRevPeriod(uint32_t dt_us);
+  void _clearRevRing();
+  void _inferDirection();
 
 private:
   Config   _cfg;
@@ -79,6 +165,10 @@ private:
   // Calibrador
   SectorCalibrator* _cal = nullptr;
 
+  // Estimadores en sombra
+  SpeedEstimators*  _est = nullptr;
+  uint64_t          _pulseTsUs = 0;   // timestamp del pulso en proceso
+
   // Dirección de indexado (+1/-1)
   int8_t   _stepDir = +1;
 
@@ -87,16 +177,47 @@ private:
 
   // Snapshots escritos por ISR (protegidos con portMUX)
   volatile uint32_t _isrCount    = 0;   // # pulsos aceptados
-  volatile uint32_t _isrLastUs   = 0;   // timestamp último pulso aceptado
+  volatile uint64_t _isrLastUs   = 0;   // timestamp último pulso aceptado (Timebase)
   volatile uint32_t _isrPeriodUs = 0;   // último período válido (us)
   portMUX_TYPE      _mux         = portMUX_INITIALIZER_UNLOCKED;
 
+  // Captura HW: ticks APB -> línea de tiempo Timebase en us (resto de ticks conservado)
+  static const uint32_t kCapTicksPerUs  = 80;          // APB 80 MHz, prescale 1
+  static const uint32_t kCapWrapGuardUs = 50000000UL;  // contador de 32 bits da la vuelta a ~53.7 s
+  volatile bool     _capPrimed     = false;
+  volatile uint32_t _capLastTicks  = 0;
+  volatile uint64_t _capLastCoarse = 0;
+  volatile uint32_t _capFrac       = 0;
+  volatile uint64_t _capUs         = 0;
+
+  // Histograma de latencia (escrito en ISR)
+  volatile uint32_t _latHist[kLatBins];
+  volatile uint32_t _latMaxUs      = 0;
+  volatile int32_t  _latMinOffUs   = 0;
+  volatile bool     _latPrimed     = false;
+
   // Estado SW
   long     _totalCount   = 0;
   float    _periodEmaUs  = 0.0f;
   float    _rpm          = 0.0f;
   float    _omega        = 0.0f;  // magnitud (>=0)
-  uint32_t _lastSeenMs   = 0;
+  uint64_t _lastSeenUs   = 0;
+  uint32_t _lastConsumed = 0;     // último _isrCount consumido por update()
+  uint32_t _sampleSeq    = 0;
+  uint64_t _lastSampleUs = 0;
+
+  // Anillo de una vuelta (periodos crudos, us)
+  uint32_t _revBuf[kRevRingMax];
+  uint16_t _revLen  = 1;          // min(PPR, kRevRingMax)
+  uint16_t _revHead = 0;
+  uint16_t _revFill = 0;
+  uint32_t _revSumUs = 0;
+
+  // Dirección inferida
+  int8_t   _dirInferred  = +1;
+  float    _dirConf      = 0.0f;
+  int8_t   _dirCandidate = +1;
+  uint8_t  _dirAgree     = 0;
 
   // Debug / Log
   Stream*  _log          = nullptr;
@@ -0,0 +1,114 @@
+#ifndef GRID_OPS_H
+#define GRID_OPS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "PotentialField.h"
+
+// ============================================================
+// GridOps — Piezas comunes de los mapas de ocupación (header-only)
+// - castRay(): Bresenham entero sobre una rejilla W x H; visita las celdas
+//   del rayo (last = celda final) y corta al salir del mapa.
+// - TileBits: un bit por tile (regiones sucias), sobre memoria ajena.
+// - obstaclesNear(): celdas ocupadas de cualquier mapa con la API de
+//   OccupancyGrid (logOdds/cellToWorld/config) como repulsores.
+// ============================================================
+namespace grid {
+
+// Devuelve las celdas visitadas; clipped = el rayo salió del mapa
+template <class Visit>
+inline uint32_t castRay(int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                        uint32_t W, uint32_t H, Visit& visit, bool& clipped) {
+  const int32_t dx = (x1 > x0) ? x1 - x0 : x0 - x1;
+  const int32_t dy = (y1 > y0) ? y0 - y1 : y1 - y0;   // -|dy|
+  const int32_t sx = (x0 < x1) ? 1 : -1;
+  const int32_t sy = (y0 < y1) ? 1 : -1;
+  int32_t err = dx + dy;
+  int32_t x = x0, y = y0;
+  uint32_t n = 0;
+  clipped = false;
+
+  while (x != x1 || y != y1) {
+    visit(x, y, false);
+    n++;
+    const int32_t e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x += sx; }
+    if (e2 <= dx) { err += dx; y += sy; }
+    if ((uint32_t)x >= W || (uint32_t)y >= H) { clipped = true; return n; }
+  }
+  visit(x, y, true);
+  return n + 1;
+}
+
+struct TileBits {
+  uint8_t* bits = nullptr;
+  uint32_t n    = 0;       // tiles
+
+  size_t bytes() const { return (n + 7) / 8; }
+  inline void set(uint32_t t)        { bits[t >> 3] |= (uint8_t)(1u << (t & 7u)); }
+  inline bool test(uint32_t t) const { return (bits[t >> 3] >> (t & 7u)) & 1u; }
+  void clear() { memset(bits, 0, bytes()); }
+  void setAll() {
+    memset(bits, 0xFF, bytes());
+    if (n & 7u) bits[n >> 3] = (uint8_t)((1u << (n & 7u)) - 1u);
+  }
+  uint32_t count() const {
+    uint32_t c = 0;
+    for (size_t i=0;i<bytes();i++) { uint8_t b = bits[i]; while (b) { b &= (uint8_t)(b - 1); c++; } }
+    return c;
+  }
+  // Siguiente bit activo desde cursor (lo limpia); salta bytes vacíos
+  bool take(uint32_t& cursor, uint32_t& t) {
+    while (cursor < n) {
+      const uint8_t b = bits[cursor >> 3];
+      if (b == 0) { cursor = (cursor | 7u) + 1; continue; }
+      t = cursor++;
+      if (!((b >> (t & 7u)) & 1u)) continue;
+      bits[t >> 3] &= (uint8_t)~(1u << (t & 7u));
+      return true;
+    }
+    return false;
+  }
+};
+
+template <class Map>
+inline uint8_t obstaclesNear(const Map& m, float x, float y, float radius,
+                             PotentialField::Obstacle* out, uint8_t max) {
+  if (max == 0) return 0;
+  const typename Map::Config& c = m.config();
+  const float inv = 1.0f / c.resolution;
+  const int32_t r  = (int32_t)ceilf(radius * inv);
+  const int32_t cx = (int32_t)floorf((x - c.originX) * inv);
+  const int32_t cy = (int32_t)floorf((y - c.originY) * inv);
+  const int32_t xa = (cx - r < 0) ? 0 : cx - r, xb = (cx + r >= (int32_t)c.width)  ? c.width  - 1 : cx + r;
+  const int32_t ya = (cy - r < 0) ? 0 : cy - r, yb = (cy + r >= (int32_t)c.height) ? c.height - 1 : cy + r;
+  const float r2 = radius * radius;
+
+  float   d2[256];
+  uint8_t n = 0;
+  for (int32_t j=ya;j<=yb;j++) {
+    for (int32_t i=xa;i<=xb;i++) {
+      if (m.logOdds(i, j) < c.lOcc) continue;
+      float ox, oy;
+      m.cellToWorld(i, j, ox, oy);
+      const float e2 = (ox - x) * (ox - x) + (oy - y) * (oy - y);
+      if (e2 > r2) continue;
+      // Llena; luego sustituye al más lejano
+      uint8_t slot = n;
+      if (n < max) n++;
+      else {
+        slot = 0;
+        for (uint8_t k=1;k<max;k++) if (d2[k] > d2[slot]) slot = k;
+        if (d2[slot] <= e2) continue;
+      }
+      out[slot].x = ox; out[slot].y = oy; out[slot].r = 0.5f * c.resolution;
+      d2[slot] = e2;
+    }
+  }
+  return n;
+}
+
+} // namespace grid
+
+#endif // GRID_OPS_H
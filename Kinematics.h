@@ -0,0 +1,125 @@
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+#include <stdint.h>
+#include <math.h>
+
+// ============================================================
+// Kinematics — Políticas de cinemática de base móvil (header-only)
+// - Twist del robot (vx [m/s], vy [m/s], w [rad/s]) <-> omegas de rueda [rad/s].
+// - Inversas de la geometría precalculadas en el constructor constexpr:
+//   inverse() queda en sumas y productos (sin divisiones en el lazo).
+// - Misma interfaz en todas para usarse como parámetro de plantilla
+//   (ver MultiWheelDrive<Kin>):
+//     static const uint8_t kWheels; static const bool kHolonomic;
+//     void inverse(vx, vy, w, float* omega) const;
+//     void forward(const float* omega, float& vx, float& vy, float& w) const;
+// - wrapPi(): envoltura de ángulos común a odometría, planificadores y sim.
+// ============================================================
+namespace kin {
+
+// Radio no válido -> 1 mm (mismo criterio que DifferentialDrive)
+constexpr float safeRadius(float r) { return (r > 1e-9f) ? r : 1e-3f; }
+
+// Ángulo a [-pi, pi). Vale para rumbos acumulados grandes (odometría sin envolver)
+inline float wrapPi(float a) {
+  const float kPi = 3.14159265f, k2Pi = 6.28318531f;
+  a = fmodf(a + kPi, k2Pi);
+  if (a < 0.0f) a += k2Pi;
+  return a - kPi;
+}
+
+// ------------------------------------------------------------
+// Diff2 — Diferencial de 2 ruedas. Orden: [0]=R, [1]=L
+// ------------------------------------------------------------
+struct Diff2 {
+  static const uint8_t kWheels    = 2;
+  static const bool    kHolonomic = false;
+
+  float r, halfL;            // geometría
+  float invR, halfLInvR;     // 1/r, (L/2)/r
+  float rHalf, rInvL;        // r/2, r/L (directa)
+
+  constexpr Diff2(float wheelRadius, float trackWidth)
+  : r(safeRadius(wheelRadius)), halfL(0.5f * trackWidth),
+    invR(1.0f / safeRadius(wheelRadius)),
+    halfLInvR(0.5f * trackWidth / safeRadius(wheelRadius)),
+    rHalf(0.5f * safeRadius(wheelRadius)),
+    rInvL((trackWidth > 1e-9f) ? safeRadius(wheelRadius) / trackWidth : 0.0f) {}
+
+  inline void inverse(float vx, float /*vy*/, float w, float* om) const {
+    const float a = vx * invR, b = w * halfLInvR;
+    om[0] = a + b;
+    om[1] = a - b;
+  }
+
+  inline void forward(const float* om, float& vx, float& vy, float& w) const {
+    vx = rHalf * (om[0] + om[1]);
+    vy = 0.0f;
+    w  = rInvL * (om[0] - om[1]);
+  }
+};
+
+// ------------------------------------------------------------
+// SkidSteer4 — 4 ruedas sin dirección. Orden: [0]=FR, [1]=FL, [2]=RR, [3]=RL
+// - Modelo diferencial con vía efectiva = trackWidth · slipFactor (>=1),
+//   que absorbe el deslizamiento lateral al girar.
+// ------------------------------------------------------------
+struct SkidSteer4 {
+  static const uint8_t kWheels    = 4;
+  static const bool    kHolonomic = false;
+
+  Diff2 side;   // un "lado" equivalente por par de ruedas
+
+  constexpr SkidSteer4(float wheelRadius, float trackWidth, float slipFactor = 1.0f)
+  : side(wheelRadius, trackWidth * ((slipFactor > 1.0f) ? slipFactor : 1.0f)) {}
+
+  inline void inverse(float vx, float vy, float w, float* om) const {
+    float s[2];
+    side.inverse(vx, vy, w, s);
+    om[0] = om[2] = s[0];   // derecha
+    om[1] = om[3] = s[1];   // izquierda
+  }
+
+  inline void forward(const float* om, float& vx, float& vy, float& w) const {
+    const float s[2] = { 0.5f * (om[0] + om[2]), 0.5f * (om[1] + om[3]) };
+    side.forward(s, vx, vy, w);
+  }
+};
+
+// ------------------------------------------------------------
+// Mecanum4 — Rodillos a 45°. Orden: [0]=FL, [1]=FR, [2]=RL, [3]=RR
+// - lx: semidistancia entre ejes (adelante/atrás), ly: semivía (izq/der).
+// ------------------------------------------------------------
+struct Mecanum4 {
+  static const uint8_t kWheels    = 4;
+  static const bool    kHolonomic = true;
+
+  float invR, kInvR;      // 1/r, (lx+ly)/r
+  float rQuarter, rInvK4; // r/4, r/(4(lx+ly))
+
+  constexpr Mecanum4(float wheelRadius, float halfWheelbase, float halfTrack)
+  : invR(1.0f / safeRadius(wheelRadius)),
+    kInvR((halfWheelbase + halfTrack) / safeRadius(wheelRadius)),
+    rQuarter(0.25f * safeRadius(wheelRadius)),
+    rInvK4((halfWheelbase + halfTrack > 1e-9f)
+             ? 0.25f * safeRadius(wheelRadius) / (halfWheelbase + halfTrack) : 0.0f) {}
+
+  inline void inverse(float vx, float vy, float w, float* om) const {
+    const float a = vx * invR, b = vy * invR, c = w * kInvR;
+    om[0] = a - b - c;   // FL
+    om[1] = a + b + c;   // FR
+    om[2] = a + b - c;   // RL
+    om[3] = a - b + c;   // RR
+  }
+
+  inline void forward(const float* om, float& vx, float& vy, float& w) const {
+    vx = rQuarter * ( om[0] + om[1] + om[2] + om[3]);
+    vy = rQuarter * (-om[0] + om[1] + om[2] - om[3]);
+    w  = rInvK4   * (-om[0] + om[1] - om[2] + om[3]);
+  }
+};
+
+} // namespace kin
+
+#endif // KINEMATICS_H
@@ -0,0 +1,191 @@
+#include "MapPartition.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include "esp_partition.h"
+  #include "esp_spi_flash.h"
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+static_assert(sizeof(MapPartition::Header) == 64, "MapPartition::Header debe ocupar 64 B");
+
+// ============================================================
+// Backends
+// ============================================================
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+
+// Partición de datos propia: en partitions.csv
+//   maps, data, 0x40, , 1M
+static const esp_partition_subtype_t kMapSubtype = (esp_partition_subtype_t)0x40;
+
+static const uint8_t* _espMap(const char* label, size_t& bytes, void** handle) {
+  const esp_partition_t* p = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, kMapSubtype, label);
+  if (!p) return nullptr;
+  const void* ptr = nullptr;
+  spi_flash_mmap_handle_t h;
+  if (esp_partition_mmap(p, 0, p->size, SPI_FLASH_MMAP_DATA, &ptr, &h) != ESP_OK) return nullptr;
+  bytes   = p->size;
+  *handle = (void*)(uintptr_t)h;
+  return (const uint8_t*)ptr;
+}
+
+static void _espUnmap(void* handle) {
+  spi_flash_munmap((spi_flash_mmap_handle_t)(uintptr_t)handle);
+}
+
+MapPartition::Backend MapPartition::defaultBackend() {
+  Backend be;
+  be.map   = _espMap;
+  be.unmap = _espUnmap;
+  return be;
+}
+
+#else
+
+// Host: archivo de imagen con mmap de solo lectura (mismo formato)
+struct HostMap { void* p; size_t n; };
+
+static const uint8_t* _hostMap(const char* path, size_t& bytes, void** handle) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) return nullptr;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return nullptr; }
+  void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) return nullptr;
+  HostMap* m = new HostMap;
+  m->p = p; m->n = (size_t)st.st_size;
+  bytes   = m->n;
+  *handle = m;
+  return (const uint8_t*)p;
+}
+
+static void _hostUnmap(void* handle) {
+  HostMap* m = (HostMap*)handle;
+  munmap(m->p, m->n);
+  delete m;
+}
+
+MapPartition::Backend MapPartition::defaultBackend() {
+  Backend be;
+  be.map   = _hostMap;
+  be.unmap = _hostUnmap;
+  return be;
+}
+
+#endif
+
+// ============================================================
+// MapPartition
+// ============================================================
+
+MapPartition::MapPartition() : _be(defaultBackend()) {}
+MapPartition::MapPartition(const Backend& be) : _be(be) {}
+MapPartition::~MapPartition() { end(); }
+
+bool MapPartition::begin(const char* name, bool verifyCrc) {
+  end();
+  size_t bytes = 0;
+  const uint8_t* p = _be.map(name, bytes, &_handle);
+  if (!p) return false;
+  _base  = p;
+  _bytes = bytes;
+  _h     = (const Header*)p;
+  if (!_validate_(bytes) ||
+      (verifyCrc && crc32(_base + _h->headerBytes, _h->payloadBytes) != _h->crc32)) {
+    end();
+    return false;
+  }
+  return true;
+}
+
+void MapPartition::end() {
+  if (_handle) _be.unmap(_handle);
+  _handle = nullptr;
+  _base = nullptr;
+  _h = nullptr;
+  _bytes = 0;
+}
+
+bool MapPartition::_validate_(size_t bytes) const {
+  if (bytes < sizeof(Header)) return false;
+  const Header& h = *_h;
+  if (h.magic != kMagic || h.version != kVersion || h.headerBytes < sizeof(Header)) return false;
+  if (h.width == 0 || h.height == 0 || h.tileShift == 0 || h.tileShift > 7) return false;
+  if ((size_t)h.headerBytes + h.payloadBytes > bytes) return false;
+  const uint32_t ts = 1u << h.tileShift;
+  if (h.tilesX != (h.width + ts - 1) / ts || h.tilesY != (h.height + ts - 1) / ts) return false;
+
+  const uint8_t want[kLayerCount] = { 1, 2, 2 };
+  for (uint8_t l=0;l<kLayerCount;l++) {
+    if (!((h.layerMask >> l) & 1u)) continue;
+    if (h.cellBytes[l] != want[l] || (h.layerOffset[l] % kLayerAlign) != 0) return false;
+    const size_t layerBytes = (size_t)h.tilesX * h.tilesY * (ts * ts) * h.cellBytes[l];
+    if ((size_t)h.layerOffset[l] + layerBytes > (size_t)h.headerBytes + h.payloadBytes) return false;
+  }
+  return true;
+}
+
+uint32_t MapPartition::crc32(const uint8_t* p, size_t n, uint32_t crc) {
+  // CRC-32 (IEEE, reflejado) bit a bit: solo se usa al validar/generar
+  crc = ~crc;
+  for (size_t i=0;i<n;i++) {
+    crc ^= p[i];
+    for (uint8_t k=0;k<8;k++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+// ---------- Geometría ----------
+
+bool MapPartition::worldToCell(float x, float y, int32_t& cx, int32_t& cy) const {
+  if (!_h) return false;
+  const float inv = 1.0f / _h->resolution;
+  cx = (int32_t)floorf((x - _h->originX) * inv);
+  cy = (int32_t)floorf((y - _h->originY) * inv);
+  return (uint32_t)cx < _h->width && (uint32_t)cy < _h->height;
+}
+
+void MapPartition::cellToWorld(int32_t cx, int32_t cy, float& x, float& y) const {
+  x = _h->originX + (cx + 0.5f) * _h->resolution;
+  y = _h->originY + (cy + 0.5f) * _h->resolution;
+}
+
+// ---------- Campos ----------
+
+bool MapPartition::distanceGradient(float x, float y, float& d, float& gx, float& gy) const {
+  int32_t cx, cy;
+  if (!hasLayer(Distance) || !worldToCell(x, y, cx, cy)) return false;
+  const int32_t xa = (cx > 0) ? cx - 1 : cx, xb = (cx + 1 < _h->width)  ? cx + 1 : cx;
+  const int32_t ya = (cy > 0) ? cy - 1 : cy, yb = (cy + 1 < _h->height) ? cy + 1 : cy;
+  d = distanceMm(cx, cy) * 1e-3f;
+  const float res = _h->resolution;
+  gx = (xb > xa) ? ((float)distanceMm(xb, cy) - (float)distanceMm(xa, cy)) * 1e-3f / ((xb - xa) * res) : 0.0f;
+  gy = (yb > ya) ? ((float)distanceMm(cx, yb) - (float)distanceMm(cx, ya)) * 1e-3f / ((yb - ya) * res) : 0.0f;
+  return true;
+}
+
+bool MapPartition::navigationStep(float x, float y, float& dirX, float& dirY) const {
+  int32_t cx, cy;
+  if (!hasLayer(Navigation) || !worldToCell(x, y, cx, cy)) return false;
+  const uint16_t c0 = navigationMm(cx, cy);
+  if (c0 == 0) return false;   // en la meta; desde una celda inflada sale al vecino alcanzable
+
+  uint16_t best = c0;
+  int32_t bx = 0, by = 0;
+  for (int32_t dy=-1;dy<=1;dy++) for (int32_t dx=-1;dx<=1;dx++) {
+    const int32_t nx = cx + dx, ny = cy + dy;
+    if ((dx | dy) == 0 || (uint32_t)nx >= _h->width || (uint32_t)ny >= _h->height) continue;
+    const uint16_t c = navigationMm(nx, ny);
+    if (c < best) { best = c; bx = dx; by = dy; }
+  }
+  if (best == c0) return false;
+  const float inv = ((bx & by) != 0) ? 0.70710678f : 1.0f;
+  dirX = bx * inv; dirY = by * inv;
+  return true;
+}
@@ -0,0 +1,122 @@
+#ifndef MAP_PARTITION_H
+#define MAP_PARTITION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// MapPartition — Mapa estático y campos precalculados en flash
+// - Imagen en una partición de datos propia (subtipo 0x40, etiqueta "maps"),
+//   mapeada con esp_partition_mmap: se lee en sitio a través de la caché,
+//   sin copiar nada a RAM.
+// - Capas opcionales sobre la misma rejilla:
+//     Occupancy  int8  log-odds (mismas unidades que OccupancyGrid)
+//     Distance   uint16 distancia al obstáculo más cercano [mm]
+//     Navigation uint16 coste a la meta [mm] (0xFFFF = inalcanzable)
+// - Almacenamiento por tiles de 2^tileShift celdas: cada tile es contiguo
+//   (256/512 B) y cada capa empieza alineada a 4 KiB, así una consulta local
+//   toca pocas líneas de caché.
+// - Backend por punteros a función: ESP32 (partición) o host (archivo con
+//   mmap), mismo formato. La imagen la genera sim/mapimage.cpp.
+// ============================================================
+class MapPartition {
+public:
+  enum Layer : uint8_t { Occupancy = 0, Distance, Navigation, kLayerCount };
+
+  static const uint32_t kMagic       = 0x3150414Du;   // "MAP1"
+  static const uint16_t kVersion     = 1;
+  static const uint32_t kLayerAlign  = 4096;
+  static const uint16_t kUnreachable = 0xFFFF;
+
+  // Cabecera en el offset 0 (little-endian, 64 B, leída en sitio)
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerBytes;
+    uint16_t width, height;          // [celdas]
+    float    resolution;             // [m/celda]
+    float    originX, originY;       // [m] esquina de la celda (0,0)
+    uint8_t  tileShift;
+    uint8_t  layerMask;              // bit i = capa i presente
+    uint16_t reserved0;
+    uint16_t tilesX, tilesY;
+    uint32_t layerOffset[kLayerCount];   // desde el inicio de la imagen
+    uint8_t  cellBytes[kLayerCount];
+    uint8_t  reserved1;
+    uint32_t payloadBytes;           // tras la cabecera
+    uint32_t crc32;                  // de [headerBytes, headerBytes + payloadBytes)
+    uint16_t goalX, goalY;           // celda meta de Navigation
+    uint32_t reserved2;
+  };
+
+  struct Backend {
+    // Mapea el origen completo en solo lectura; *handle para unmap
+    const uint8_t* (*map)(const char* name, size_t& bytes, void** handle);
+    void (*unmap)(void* handle);
+  };
+
+  MapPartition();
+  explicit MapPartition(const Backend& be);
+  ~MapPartition();
+
+  static Backend defaultBackend();       // partición (ESP32) o archivo (host)
+
+  // name: etiqueta de la partición (ESP32) o ruta del archivo (host).
+  // verifyCrc recorre toda la imagen (lento en flash grande: solo al arrancar).
+  bool begin(const char* name = "maps", bool verifyCrc = false);
+  void end();
+  bool ok() const { return _h != nullptr; }
+
+  static uint32_t crc32(const uint8_t* p, size_t n, uint32_t crc = 0);
+
+  // --- Geometría ---
+  const Header& header() const { return *_h; }
+  uint16_t width()  const { return _h->width; }
+  uint16_t height() const { return _h->height; }
+  float    resolution() const { return _h->resolution; }
+  bool     hasLayer(Layer l) const { return _h && ((_h->layerMask >> l) & 1u); }
+  bool     worldToCell(float x, float y, int32_t& cx, int32_t& cy) const;
+  void     cellToWorld(int32_t cx, int32_t cy, float& x, float& y) const;
+
+  // --- Acceso en sitio (sin comprobar límites: usar worldToCell) ---
+  const uint8_t* tile(Layer l, uint16_t tx, uint16_t ty) const {
+    const uint32_t tb = (uint32_t)_h->cellBytes[l] << (2 * _h->tileShift);
+    return _base + _h->layerOffset[l] + ((uint32_t)ty * _h->tilesX + tx) * tb;
+  }
+  inline int8_t occupancy(int32_t cx, int32_t cy) const {
+    return (int8_t)_base[_cellOffset_(Occupancy, cx, cy)];
+  }
+  inline uint16_t distanceMm(int32_t cx, int32_t cy) const {
+    return *(const uint16_t*)(_base + _cellOffset_(Distance, cx, cy));
+  }
+  inline uint16_t navigationMm(int32_t cx, int32_t cy) const {
+    return *(const uint16_t*)(_base + _cellOffset_(Navigation, cx, cy));
+  }
+
+  // Distancia [m] y su gradiente (dirección de alejarse) por diferencias
+  // centrales sobre la capa Distance; false si fuera del mapa o sin capa
+  bool distanceGradient(float x, float y, float& d, float& gx, float& gy) const;
+
+  // Dirección de bajada del campo de navegación (vecino 8-conexo de menor
+  // coste; desde una celda inflada lleva a la zona alcanzable); false en la
+  // meta, fuera del mapa o sin vecino mejor
+  bool navigationStep(float x, float y, float& dirX, float& dirY) const;
+
+private:
+  inline uint32_t _cellOffset_(Layer l, int32_t cx, int32_t cy) const {
+    const uint8_t  s = _h->tileShift;
+    const uint32_t m = (1u << s) - 1u;
+    const uint32_t t = ((uint32_t)cy >> s) * _h->tilesX + ((uint32_t)cx >> s);
+    const uint32_t in = (((uint32_t)cy & m) << s) | ((uint32_t)cx & m);
+    return _h->layerOffset[l] + ((t << (2 * s)) + in) * _h->cellBytes[l];
+  }
+  bool _validate_(size_t bytes) const;
+
+  Backend        _be;
+  void*          _handle = nullptr;
+  const uint8_t* _base   = nullptr;
+  const Header*  _h      = nullptr;
+  size_t         _bytes  = 0;
+};
+
+#endif // MAP_PARTITION_H
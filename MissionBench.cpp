@@ -0,0 +1,6 @@
+#include "MissionBenchImpl.h"
+
+// Instanciación por defecto (ver MissionBench.h)
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+template class MissionBenchT<DifferentialDrive>;
+#endif
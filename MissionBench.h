@@ -0,0 +1,154 @@
+#ifndef MISSION_BENCH_H
+#define MISSION_BENCH_H
+
+#include <stdint.h>
+#include "TrajectoryRunner.h"
+#include "PotentialField.h"
+#include "Timebase.h"
+
+// ============================================================
+// MissionBench — Misiones estándar y tabla de resultados
+// - Misiones: cuadrado, secuencia punto a punto, slalom y pista de
+//   obstáculos (campo de potencial con obstáculos virtuales).
+// - Punto a punto con TrajectoryRunner (giro + avance) sobre la odometría
+//   de DifferentialDrive; la pista usa PotentialField -> setTwist().
+//   Tramos en trapezoide o de mínima energía (Config::energyTimeScale),
+//   para comparar ambos planificadores con las mismas misiones.
+// - Por misión: tiempo a meta, error final de pose, longitud de camino,
+//   energía (modelo de TrajectoryRunner sobre v/w medidas) y CPU de
+//   control por tick (media y máximo).
+// - Error de pose respecto a la odometría: sin referencia externa mide la
+//   ejecución del plan, no la deriva de los encoders.
+// - No bloquea: start()/startAll() y luego update(dt) a ritmo fijo.
+// - Drive como parámetro de plantilla (igual que TrajectoryRunnerT):
+//   'MissionBench' es la del robot (compilada en MissionBench.cpp); en host,
+//   MissionBenchT<SimDrive> con MissionBenchImpl.h corre las mismas misiones
+//   sobre la planta del simulador (sim/mission_main.cpp), reproducibles.
+// ============================================================
+template <class Drive>
+class MissionBenchT {
+public:
+  typedef TrajectoryRunnerT<Drive> Runner;
+
+  enum Mission : uint8_t { Square = 0, PointToPoint, Slalom, ObstacleCourse, kMissionCount };
+
+  static const uint8_t kMaxWaypoints = 12;
+  static const uint8_t kMaxPoints    = 8;
+
+  struct Config {
+    float squareSide   = 0.50f;   // [m]
+    uint8_t nPoints    = 4;       // punto a punto (marco del mundo, parte de 0,0)
+    float points[kMaxPoints][2] = { {0.50f, 0.20f}, {0.10f, 0.50f}, {-0.30f, 0.10f}, {0.0f, 0.0f} };
+    uint8_t slalomGates = 4;      // conos alternos
+    float slalomPitch  = 0.40f;   // [m] separación en x
+    float slalomAmp    = 0.20f;   // [m] desvío lateral
+
+    // Pista de obstáculos: meta y obstáculos (x, y, r)
+    float courseGoalX  = 1.50f, courseGoalY = 0.0f;
+    uint8_t nCourseObs = 3;
+    float courseObs[PotentialField::kMaxObstacles][3] =
+      { {0.50f, 0.05f, 0.08f}, {0.90f, -0.15f, 0.08f}, {1.15f, 0.20f, 0.06f} };
+    PotentialField::Config pf;
+
+    float vPeak        = 0.0f;    // 0 => defaults del runner
+    float wPeak        = 0.0f;
+    // Plan de cada tramo: 0 => trapezoide; >= 1 => mínima energía
+    // (planRotateAdvanceMinEnergy) llegando en escala × t del trapezoide
+    float energyTimeScale = 0.0f;
+    float timeoutS     = 60.0f;   // por misión
+    float settleS      = 1.0f;    // pausa quieto antes de cada misión
+  };
+
+  struct Result {
+    bool     valid     = false;
+    bool     reached   = false;
+    float    timeS     = 0.0f;    // tiempo a meta (o al timeout)
+    float    posErrM   = 0.0f;    // |p_final - meta|
+    float    headErrRad= 0.0f;    // rumbo final vs rumbo del último tramo
+    float    pathM     = 0.0f;
+    float    energyJ   = 0.0f;
+    float    minClearM = 0.0f;    // solo pista de obstáculos
+    uint32_t ticks     = 0;
+    float    cpuUsAvg  = 0.0f;    // control por tick
+    uint32_t cpuUsMax  = 0;
+  };
+
+  MissionBenchT(const Config& cfg, Runner& runner);
+
+  bool start(Mission m);     // false si ya hay una en curso
+  bool startAll();           // todas en orden
+  void abort();
+
+  // Llamar a ritmo fijo (sustituye a runner.update()/drive.update())
+  void update(float dt_s);
+
+  bool busy() const { return _phase != Idle; }
+  const Result& result(Mission m) const { return _res[m]; }
+  static const char* name(Mission m);
+
+  // Tabla de resultados en cualquier Out con printf() (Stream en el robot)
+  template <class Out> void printScorecard(Out& s) const;
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  void printScorecard() const { printScorecard(Serial); }
+#endif
+  void setLog(Stream* s) { _log = s; }
+
+private:
+  enum Phase { Idle, Settling, Running };
+
+  void _begin_(Mission m);
+  void _buildWaypoints_(Mission m);
+  void _planNext_();
+  void _finish_(bool reached);
+  void _accumulate_(float dt, uint32_t cpuUs);
+
+  Config             _cfg;
+  Runner&            _runner;
+  Drive&             _drive;
+  PotentialField     _pf;
+
+  Phase    _phase = Idle;
+  Mission  _cur   = Square;
+  bool     _all   = false;
+  float    _t     = 0.0f;
+
+  float    _wp[kMaxWaypoints][2];
+  uint8_t  _nWp = 0, _iWp = 0;
+  float    _legHeading = 0.0f;
+
+  float    _vPrev = 0.0f, _wPrev = 0.0f;
+  uint64_t _cpuSum = 0;
+  Result   _res[kMissionCount];
+
+  Stream*  _log = nullptr;
+};
+
+// Tabla: plantilla sobre la salida, definida aquí para cualquier Out
+template <class Drive>
+template <class Out>
+void MissionBenchT<Drive>::printScorecard(Out& s) const {
+  s.printf("[MB] %-10s %4s %8s %8s %8s %8s %8s %8s %8s %7s\n",
+           "mision", "ok", "t[s]", "err[m]", "rumbo", "cam[m]", "E[J]", "cpu[us]", "max[us]", "holg[m]");
+  float tSum = 0.0f, eSum = 0.0f;
+  uint8_t nOk = 0, nRun = 0;
+  for (uint8_t i=0;i<kMissionCount;i++) {
+    const Result& r = _res[i];
+    if (!r.valid) continue;
+    nRun++; if (r.reached) nOk++;
+    tSum += r.timeS; eSum += r.energyJ;
+    s.printf("[MB] %-10s %4s %8.2f %8.3f %8.3f %8.2f %8.2f %8.1f %8lu %7.3f\n",
+             name((Mission)i), r.reached ? "si" : "NO", (double)r.timeS, (double)r.posErrM,
+             (double)r.headErrRad, (double)r.pathM, (double)r.energyJ, (double)r.cpuUsAvg,
+             (unsigned long)r.cpuUsMax, (double)r.minClearM);
+  }
+  s.printf("[MB] total: %u/%u a meta  t=%.2f s  E=%.2f J\n",
+           (unsigned)nOk, (unsigned)nRun, (double)tSum, (double)eSum);
+}
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+// Instanciación por defecto sobre el drive real
+typedef MissionBenchT<DifferentialDrive> MissionBench;
+extern template class MissionBenchT<DifferentialDrive>;
+#endif
+
+#endif // MISSION_BENCH_H
@@ -0,0 +1,235 @@
+#ifndef MISSION_BENCH_IMPL_H
+#define MISSION_BENCH_IMPL_H
+
+#include "MissionBench.h"
+#include <math.h>
+
+// ============================================================
+// MissionBenchImpl — Definiciones de MissionBenchT<Drive>
+// - Incluir solo donde se instancia otro Drive (host: sim/SimDrive.h,
+//   junto con TrajectoryRunnerImpl.h); MissionBench ya está compilada en
+//   MissionBench.cpp.
+// ============================================================
+
+#define MBT_TEMPLATE template <class Drive>
+#define MBT          MissionBenchT<Drive>
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #define MB_LOGF(fmt, ...) do { if (_log) _log->printf(fmt, ##__VA_ARGS__); } while(0)
+#else
+  #include <stdio.h>   // host: sin Stream; los argumentos se siguen compilando
+  #define MB_LOGF(fmt, ...) do { (void)_log; if (0) printf(fmt, ##__VA_ARGS__); } while(0)
+#endif
+
+MBT_TEMPLATE
+MBT::MissionBenchT(const Config& cfg, Runner& runner)
+: _cfg(cfg), _runner(runner), _drive(runner.drive()), _pf(cfg.pf) {}
+
+MBT_TEMPLATE
+const char* MBT::name(Mission m) {
+  switch (m) {
+    case Square:         return "square";
+    case PointToPoint:   return "p2p";
+    case Slalom:         return "slalom";
+    case ObstacleCourse: return "obstacles";
+    default:             return "?";
+  }
+}
+
+MBT_TEMPLATE
+bool MBT::start(Mission m) {
+  if (_phase != Idle || m >= kMissionCount) return false;
+  _all = false;
+  _begin_(m);
+  return true;
+}
+
+MBT_TEMPLATE
+bool MBT::startAll() {
+  if (_phase != Idle) return false;
+  _all = true;
+  _begin_(Square);
+  return true;
+}
+
+MBT_TEMPLATE
+void MBT::abort() {
+  if (_phase == Idle) return;
+  _runner.cancel();
+  _drive.setTwist(0.0f, 0.0f);
+  _all = false;
+  _phase = Idle;
+  MB_LOGF("[MB] abort %s\n", name(_cur));
+}
+
+// ---------- Ejecución ----------
+
+MBT_TEMPLATE
+void MBT::update(float dt_s) {
+  if (_phase == Idle) { _runner.update(dt_s); return; }
+
+  if (_phase == Settling) {
+    _runner.update(dt_s);            // plan terminado -> v=w=0
+    _t += dt_s;
+    if (_t < _cfg.settleS) return;
+
+    _drive.resetOdometry();
+    _t = 0.0f;
+    _vPrev = _wPrev = 0.0f;
+    _phase = Running;
+    if (_cur == ObstacleCourse) {
+      _pf.setGoal(_cfg.courseGoalX, _cfg.courseGoalY);
+      _legHeading = atan2f(_cfg.courseGoalY, _cfg.courseGoalX);
+    } else {
+      _planNext_();
+    }
+    return;
+  }
+
+  // Running: solo el lazo de control entra en la medida de CPU
+  Result& r = _res[_cur];
+  const uint64_t t0 = Timebase::nowUs();
+  if (_cur == ObstacleCourse) {
+    float v, w;
+    _pf.twist(_drive.odomX(), _drive.odomY(), _drive.odomTheta(), v, w);
+    _drive.setTwist(v, w);
+    _drive.update(dt_s);
+  } else {
+    _runner.update(dt_s);
+  }
+  _accumulate_(dt_s, (uint32_t)(Timebase::nowUs() - t0));
+
+  if (_cur == ObstacleCourse) {
+    const float c = _pf.clearance(_drive.odomX(), _drive.odomY());
+    if (c < r.minClearM) r.minClearM = c;
+    if (_pf.reached(_drive.odomX(), _drive.odomY())) { _drive.setTwist(0.0f, 0.0f); _finish_(true); return; }
+  } else if (_runner.isFinished()) {
+    if (++_iWp >= _nWp) { _finish_(true); return; }
+    _planNext_();
+  }
+
+  if (_t >= _cfg.timeoutS) _finish_(false);
+}
+
+MBT_TEMPLATE
+void MBT::_accumulate_(float dt, uint32_t cpuUs) {
+  Result& r = _res[_cur];
+  _t += dt;
+  r.ticks++;
+  _cpuSum += cpuUs;
+  if (cpuUs > r.cpuUsMax) r.cpuUsMax = cpuUs;
+
+  // Energía del modelo sobre la velocidad medida (a por diferencias)
+  const float v = _drive.vMeas(), w = _drive.wMeas();
+  if (dt > 0.0f) {
+    const typename Runner::Config& tc = _runner.config();
+    const float P = tc.lin.power((v - _vPrev) / dt, v) + tc.rot.power((w - _wPrev) / dt, w);
+    r.energyJ += P * dt;
+  }
+  _vPrev = v; _wPrev = w;
+}
+
+// ---------- Misiones ----------
+
+MBT_TEMPLATE
+void MBT::_begin_(Mission m) {
+  _cur = m;
+  _res[m] = Result();
+  _res[m].minClearM = 1.0e9f;
+  _cpuSum = 0;
+  _t = 0.0f;
+  _iWp = 0;
+  _buildWaypoints_(m);
+
+  _pf.clearObstacles();
+  if (m == ObstacleCourse) {
+    for (uint8_t i=0;i<_cfg.nCourseObs && i<PotentialField::kMaxObstacles;i++)
+      _pf.addObstacle(_cfg.courseObs[i][0], _cfg.courseObs[i][1], _cfg.courseObs[i][2]);
+  }
+
+  _drive.setTwist(0.0f, 0.0f);
+  _phase = Settling;
+  MB_LOGF("[MB] start %s (%u waypoints, %u obstáculos)\n", name(m), (unsigned)_nWp, (unsigned)_pf.obstacleCount());
+}
+
+MBT_TEMPLATE
+void MBT::_buildWaypoints_(Mission m) {
+  _nWp = 0;
+  switch (m) {
+    case Square: {
+      const float s = _cfg.squareSide;
+      const float p[4][2] = { {s, 0.0f}, {s, s}, {0.0f, s}, {0.0f, 0.0f} };
+      for (uint8_t i=0;i<4;i++) { _wp[_nWp][0] = p[i][0]; _wp[_nWp][1] = p[i][1]; _nWp++; }
+      break;
+    }
+    case PointToPoint:
+      for (uint8_t i=0;i<_cfg.nPoints && i<kMaxPoints;i++) {
+        _wp[_nWp][0] = _cfg.points[i][0]; _wp[_nWp][1] = _cfg.points[i][1]; _nWp++;
+      }
+      break;
+    case Slalom: {
+      uint8_t n = _cfg.slalomGates;
+      if (n > kMaxWaypoints - 1) n = kMaxWaypoints - 1;
+      for (uint8_t i=0;i<n;i++) {
+        _wp[_nWp][0] = (i + 1) * _cfg.slalomPitch;
+        _wp[_nWp][1] = (i & 1) ? -_cfg.slalomAmp : _cfg.slalomAmp;
+        _nWp++;
+      }
+      _wp[_nWp][0] = (n + 1) * _cfg.slalomPitch; _wp[_nWp][1] = 0.0f; _nWp++;
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+MBT_TEMPLATE
+void MBT::_planNext_() {
+  // Objetivo del mundo -> marco del robot según la odometría actual
+  const float x = _drive.odomX(), y = _drive.odomY(), th = _drive.odomTheta();
+  const float dx = _wp[_iWp][0] - x, dy = _wp[_iWp][1] - y;
+  const float c = cosf(th), s = sinf(th);
+  _legHeading = atan2f(dy, dx);
+  const float xR = c * dx + s * dy, yR = -s * dx + c * dy;
+  if (_cfg.energyTimeScale <= 0.0f) {
+    _runner.planFromPointInRobotFrame(xR, yR, _cfg.wPeak, _cfg.vPeak);
+    return;
+  }
+  // Mínima energía con la duración del trapezoide como referencia
+  const float dtheta = atan2f(yR, xR), dist = hypotf(xR, yR);
+  _runner.planRotateAdvance(dtheta, dist, _cfg.wPeak, _cfg.vPeak);
+  const float tArrive = _runner.planDuration() * ((_cfg.energyTimeScale > 1.0f) ? _cfg.energyTimeScale : 1.0f);
+  _runner.planRotateAdvanceMinEnergy(dtheta, dist, tArrive, _cfg.wPeak, _cfg.vPeak);
+}
+
+MBT_TEMPLATE
+void MBT::_finish_(bool reached) {
+  Result& r = _res[_cur];
+  float gx, gy;
+  if (_cur == ObstacleCourse) { gx = _cfg.courseGoalX; gy = _cfg.courseGoalY; }
+  else if (_nWp > 0)          { gx = _wp[_nWp - 1][0]; gy = _wp[_nWp - 1][1]; }
+  else                        { gx = gy = 0.0f; }
+
+  r.valid      = true;
+  r.reached    = reached;
+  r.timeS      = _t;
+  r.posErrM    = hypotf(_drive.odomX() - gx, _drive.odomY() - gy);
+  r.headErrRad = kin::wrapPi(_drive.odomTheta() - _legHeading);
+  r.pathM      = _drive.odomPath();
+  r.cpuUsAvg   = r.ticks ? (float)_cpuSum / (float)r.ticks : 0.0f;
+  if (_cur != ObstacleCourse) r.minClearM = 0.0f;
+
+  if (!reached) _runner.cancel();
+  _drive.setTwist(0.0f, 0.0f);
+  MB_LOGF("[MB] fin %s: %s t=%.2f s  err=%.3f m\n", name(_cur),
+          reached ? "OK" : "TIMEOUT", (double)r.timeS, (double)r.posErrM);
+
+  if (_all && _cur + 1 < kMissionCount) { _begin_((Mission)(_cur + 1)); return; }
+  _all = false;
+  _phase = Idle;
+}
+
+#undef MB_LOGF
+#undef MBT
+#undef MBT_TEMPLATE
+
+#endif // MISSION_BENCH_IMPL_H
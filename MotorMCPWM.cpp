@@ -0,0 +1,85 @@
+#include "MotorMCPWM.h"
+
+#define MMC_LOGF(fmt, ...) do { if (_log) _log->printf(fmt, ##__VA_ARGS__); } while(0)
+
+void MotorMCPWM::begin() {
+  // Señales A/B del timer elegido: MCPWMxA = 2·timer, MCPWMxB = 2·timer + 1
+  const int sigA = (int)MCPWM0A + 2 * (int)_cfg.timer;
+  mcpwm_gpio_init(_cfg.unit, (mcpwm_io_signals_t)sigA,       _cfg.pinIn1);
+  mcpwm_gpio_init(_cfg.unit, (mcpwm_io_signals_t)(sigA + 1), _cfg.pinIn2);
+
+  mcpwm_config_t pc;
+  pc.frequency    = _cfg.freqHz;
+  pc.cmpr_a       = 0.0f;
+  pc.cmpr_b       = 0.0f;
+  pc.duty_mode    = MCPWM_DUTY_MODE_0;
+  pc.counter_mode = MCPWM_UP_COUNTER;
+  mcpwm_init(_cfg.unit, _cfg.timer, &pc);
+
+  _forcedLow[0] = _forcedLow[1] = false;   // mcpwm_init deja ambos en modo duty
+  _uTarget = _uApplied = 0.0f;
+  _apply_(0.0f);
+
+  MMC_LOGF("[MotorMCPWM] init OK | unit=%d timer=%d f=%lu Hz\n",
+           (int)_cfg.unit, (int)_cfg.timer, (unsigned long)_cfg.freqHz);
+}
+
+void MotorMCPWM::stop() {
+  _uTarget = _uApplied = 0.0f;
+  _brake = 0.0f;
+  _apply_(0.0f);
+}
+
+void MotorMCPWM::update(float dt_s) {
+  // Slew-rate hacia el objetivo
+  if (_cfg.slewRatePerSec > 0.0f && dt_s > 0.0f) {
+    const float maxStep = _cfg.slewRatePerSec * dt_s;
+    const float err = _uTarget - _uApplied;
+    if (err >  maxStep) _uApplied += maxStep;
+    else if (err < -maxStep) _uApplied -= maxStep;
+    else _uApplied = _uTarget;
+  } else {
+    _uApplied = _uTarget;
+  }
+
+  // Deadband + piso mínimo (mismo mapeo que MotorPWM)
+  float u = _uApplied;
+  if (fabsf(u) < _cfg.deadband) {
+    u = 0.0f;
+  } else {
+    float s = (fabsf(u) - _cfg.deadband) / (1.0f - _cfg.deadband);
+    if (s > 1.0f) s = 1.0f;
+    const float y = _cfg.minOutput + (1.0f - _cfg.minOutput) * s;
+    u = (u >= 0.0f) ? y : -y;
+  }
+  _apply_(u);
+}
+
+void MotorMCPWM::_apply_(float u) {
+  if (u == 0.0f) {
+    // Freno PWM (ambos altos una fracción b) o coast
+    _braking = (_brake > 0.0f);
+    _gen_(MCPWM_GEN_A, _brake);
+    _gen_(MCPWM_GEN_B, _brake);
+    return;
+  }
+  _braking = false;
+  if (u > 0.0f) { _gen_(MCPWM_GEN_A, u);  _gen_(MCPWM_GEN_B, 0.0f); }
+  else          { _gen_(MCPWM_GEN_A, 0.0f); _gen_(MCPWM_GEN_B, -u); }
+}
+
+void MotorMCPWM::_gen_(mcpwm_generator_t g, float duty01) {
+  bool& forced = _forcedLow[(int)g];
+  if (duty01 <= 0.0f) {
+    if (!forced) mcpwm_set_signal_low(_cfg.unit, _cfg.timer, g);
+    forced = true;
+    return;
+  }
+  mcpwm_set_duty(_cfg.unit, _cfg.timer, g, duty01 * 100.0f);
+  // set_signal_low deja el generador forzado: restaurar el modo de duty
+  // solo al salir de ese estado (no en cada update)
+  if (forced) {
+    mcpwm_set_duty_type(_cfg.unit, _cfg.timer, g, MCPWM_DUTY_MODE_0);
+    forced = false;
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef MOTOR_MCPWM_H
+#define MOTOR_MCPWM_H
+
+#include <Arduino.h>
+#include "driver/mcpwm.h"
+
+// ============================================================
+// MotorMCPWM (ESP32 MCPWM) - IBT-4 / BTS7960 (IN1, IN2)
+// - Alternativa a MotorPWM para WheelT<...>: misma interfaz de comando.
+// - IN1/IN2 = generadores A/B del mismo timer MCPWM: flancos alineados y
+//   actualización de duty sincronizada al periodo (sin glitches).
+// - Sign-Magnitude con deadband, duty mínimo, slew, coast y freno PWM.
+// - Sin decay rápido (setSpeedHint se acepta y se ignora).
+// ============================================================
+class MotorMCPWM {
+public:
+  struct Config {
+    int           pinIn1         = 32;
+    int           pinIn2         = 33;
+    mcpwm_unit_t  unit           = MCPWM_UNIT_0;
+    mcpwm_timer_t timer          = MCPWM_TIMER_0;
+    uint32_t      freqHz         = 20000;
+
+    bool     invert          = false;
+    float    deadband        = 0.0f;
+    float    minOutput       = 0.0f;
+    float    slewRatePerSec  = 0.0f;
+  };
+
+  explicit MotorMCPWM(const Config& cfg) : _cfg(cfg) {}
+
+  void begin();
+  void update(float dt_s);
+
+  void  setCommand(float uSigned) {
+    if (_cfg.invert) uSigned = -uSigned;
+    _uTarget = (uSigned < -1.0f) ? -1.0f : (uSigned > 1.0f) ? 1.0f : uSigned;
+  }
+  float commandTarget()  const { return _uTarget; }
+  float commandApplied() const { return _uApplied; }
+  void  stop();
+
+  void  setBrake(float b) { _brake = constrain(b, 0.0f, 1.0f); }
+  float brakeCommand() const { return _brake; }
+  bool  braking() const { return _braking; }
+  void  setSpeedHint(float) {}
+
+  void setLog(Stream* s) { _log = s; }
+
+private:
+  void _apply_(float u);
+  void _gen_(mcpwm_generator_t g, float duty01);
+
+  Config  _cfg;
+  float   _uTarget  = 0.0f;
+  float   _uApplied = 0.0f;
+  float   _brake    = 0.0f;
+  bool    _braking  = false;
+  bool    _forcedLow[2] = { false, false };   // por generador A/B: en set_signal_low
+  Stream* _log      = nullptr;
+};
+
+#endif // MOTOR_MCPWM_H
@@ -16,11 +16,19 @@ void MotorPWM::begin() {
   _uApplied = 0.0f;
   _enabled  = true;
 
+  // Fast decay necesita ambos canales en el mismo timer (flancos alineados)
+  _fastOk = ((_cfg.chanIn1 >> 1) == (_cfg.chanIn2 >> 1));
+  if (_cfg.decayMode != DecayMode::Slow && !_fastOk) {
+    MPWM_LOGF("[MotorPWM] WARN: ch%u/ch%u en timers distintos -> decay Slow\n",
+              (unsigned)_cfg.chanIn1, (unsigned)_cfg.chanIn2);
+  }
+
   // Asegura neutral
   _neutral_();
 
-  MPWM_LOGF("[MotorPWM] init OK | f=%lu Hz, res=%u bits, maxDuty=%lu\n",
-            (unsigned long)_cfg.freqHz, (unsigned)_cfg.resolutionBits, (unsigned long)_maxDuty);
+  MPWM_LOGF("[MotorPWM] init OK | f=%lu Hz, res=%u bits, maxDuty=%lu, decay=%u\n",
+            (unsigned long)_cfg.freqHz, (unsigned)_cfg.resolutionBits, (unsigned long)_maxDuty,
+            (unsigned)_cfg.decayMode);
 }
 
 void MotorPWM::_setupLEDC() {
@@ -52,6 +60,7 @@ void MotorPWM::setCommand(float uSigned) {
 void MotorPWM::stop() {
   _uTarget = 0.0f;
   _uApplied = 0.0f;
+  _brake = 0.0f;
   _neutral_(); // salida inmediata a neutral
 }
 
@@ -90,11 +99,20 @@ float MotorPWM::_applyDeadbandMin_(float x, float deadband, float minOut) {
 }
 
 void MotorPWM::_applyOutputs_(float u) {
-  // Neutral (coast/brake) si u = 0
+  // Neutral (coast/brake) si u = 0; freno PWM si se pidió (solo Sign-Magnitude)
   if (u == 0.0f) {
-    _neutral_();
+    _fastDecay = false;
+    if (_brake > 0.0f && _cfg.driveMode == DriveMode::SignMagnitude) _brakePWM_(_brake);
+    else                                                             _neutral_();
+    return;
+  }
+  _braking = false;
+
+  if (_cfg.driveMode == DriveMode::SignMagnitude && _wantFastDecay_(u)) {
+    _writeFastDecay_(u);
     return;
   }
+  _fastDecay = false;
 
   // Magnitud en [0..1] -> duty [0..maxDuty]
   const float mag = fabsf(u);
@@ -124,7 +142,57 @@ void MotorPWM::_applyOutputs_(float u) {
   }
 }
 
+bool MotorPWM::_wantFastDecay_(float u) {
+  if (!_fastOk) return false;
+  switch (_cfg.decayMode) {
+    case DecayMode::Slow: return false;
+    case DecayMode::Fast: return true;
+    default: break;
+  }
+
+  // Auto: generando si el mando va contra el giro o por debajo de la fcem
+  // (la rueda quiere frenar). Histéresis para no conmutar en cada ciclo.
+  if (_emf == 0.0f) return false;
+  const float h = _fastDecay ? -_cfg.decayHyst : +_cfg.decayHyst;
+  if (u * _emf < 0.0f) return true;
+  return fabsf(u) + h < fabsf(_emf);
+}
+
+void MotorPWM::_writeFastDecay_(float u) {
+  // d = (1+u)/2 en IN1 desde hpoint 0; IN2 alto en el resto del periodo
+  // (hpoint = d). Tensión media = u·Vbat; en off-time la corriente se
+  // devuelve a la batería -> frenado fuerte y respuesta lineal en generación.
+  uint32_t d = (uint32_t) lroundf(0.5f * (1.0f + u) * (float)_maxDuty);
+  if (d > _maxDuty) d = _maxDuty;
+
+  const ledc_mode_t mode = (_cfg.chanIn1 < 8) ? LEDC_HIGH_SPEED_MODE : LEDC_LOW_SPEED_MODE;
+  const ledc_channel_t ch1 = (ledc_channel_t)(_cfg.chanIn1 & 7);
+  const ledc_channel_t ch2 = (ledc_channel_t)(_cfg.chanIn2 & 7);
+  ledc_set_duty_with_hpoint(mode, ch1, d, 0);
+  ledc_set_duty_with_hpoint(mode, ch2, _maxDuty - d, d);
+  ledc_update_duty(mode, ch1);
+  ledc_update_duty(mode, ch2);
+
+  _lastDutyIn1 = d;
+  _lastDutyIn2 = _maxDuty - d;
+  _hpoint2 = true;
+  if (!_fastDecay) MPWM_LOGF("[MotorPWM] decay -> FAST\n");
+  _fastDecay = true;
+}
+
+void MotorPWM::_brakePWM_(float b) {
+  // Ambos pines a la vez: durante b·T el puente cortocircuita el motor
+  // (frena con su propia fcem), el resto del periodo queda en coast.
+  // Mismo canal de timer -> flancos alineados. ¡Verifica en tu hardware!
+  uint32_t d = (uint32_t) lroundf(b * (float)_maxDuty);
+  if (d > _maxDuty) d = _maxDuty;
+  _writeIn1_(d);
+  _writeIn2_(d);
+  _braking = true;
+}
+
 void MotorPWM::_neutral_() {
+  _braking = false;
   if (_cfg.neutralMode == NeutralMode::Coast) {
     // Deja ambas entradas a 0
     _writeIn1_(0);
@@ -151,5 +219,14 @@ void MotorPWM::_writeIn1_(uint32_t d) {
 
 void MotorPWM::_writeIn2_(uint32_t d) {
   _lastDutyIn2 = d;
+  if (_hpoint2) {
+    // Sale de fast decay: IN2 vuelve a hpoint 0 (ledcWrite conserva el hpoint)
+    const ledc_mode_t mode = (_cfg.chanIn2 < 8) ? LEDC_HIGH_SPEED_MODE : LEDC_LOW_SPEED_MODE;
+    const ledc_channel_t ch2 = (ledc_channel_t)(_cfg.chanIn2 & 7);
+    ledc_set_duty_with_hpoint(mode, ch2, d, 0);
+    ledc_update_duty(mode, ch2);
+    _hpoint2 = false;
+    return;
+  }
   ledcWrite(_cfg.chanIn2, d);
 }
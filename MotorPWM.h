@@ -2,6 +2,7 @@
 #define MOTOR_PWM_H
 
 #include <Arduino.h>
+#include "driver/ledc.h"
 
 // ============================================================
 // MotorPWM (ESP32 LEDC) - IBT-4 / BTS7960 (IN1, IN2)
@@ -9,12 +10,19 @@
 // - Modo Sign-Magnitude (defecto) u>0 -> IN1 PWM, IN2=0; u<0 -> IN2 PWM, IN1=0
 // - Modo Locked-Anti-Phase (opcional) neutro = 50% / 50%
 // - Slew-rate, deadband, duty mínimo, enable/disable, coast/brake, invert
+// - Freno PWM (short-brake parcial) con u=0: ambos pines altos una fracción b
+// - Decay en Sign-Magnitude: Slow (freewheel por low-sides), Fast (IN2
+//   complementario, la corriente vuelve a la batería) o Auto por cuadrante
 // - Sin dependencia de pot/serial: tú decides de dónde viene u
 // ============================================================
 class MotorPWM {
 public:
   enum class NeutralMode : uint8_t { Coast = 0, Brake = 1 };
   enum class DriveMode   : uint8_t { SignMagnitude = 0, LockedAntiPhase = 1 };
+  // Slow: off-time con ambos low-sides (menor rizado, frenado débil)
+  // Fast: off-time invertido (IN1/IN2 complementarios), tensión = (2d-1)·Vbat
+  // Auto: Slow motorizando, Fast generando (|u| < fcem o signo opuesto)
+  enum class DecayMode   : uint8_t { Slow = 0, Fast = 1, Auto = 2 };
 
   struct Config {
     // Pines + canales LEDC
@@ -36,6 +44,11 @@ public:
     // Comportamiento para IBT-4
     NeutralMode neutralMode  = NeutralMode::Coast;           // al u=0
     DriveMode   driveMode    = DriveMode::SignMagnitude;     // modo de entrega
+
+    // Decay (solo Sign-Magnitude). Fast/Auto requieren que chanIn1/chanIn2
+    // compartan timer LEDC (pareja 2k/2k+1); si no, se usa Slow.
+    DecayMode   decayMode    = DecayMode::Slow;
+    float       decayHyst    = 0.03f;  // histéresis de |u| vs fcem para cambiar de cuadrante
   };
 
   explicit MotorPWM(const Config& cfg);
@@ -58,10 +71,22 @@ public:
   void setInvert(bool inv) { _cfg.invert = inv; }
   void setNeutralMode(NeutralMode m) { _cfg.neutralMode = m; }
   void setDriveMode(DriveMode m) { _cfg.driveMode = m; }
+  void setDecayMode(DecayMode m) { _cfg.decayMode = m; }
+
+  // Fcem normalizada con signo (w / w_sin_carga ∈ [-1..1]) para el modo Auto.
+  // La provee Wheel; 0 = desconocida (Auto se queda en Slow).
+  void setSpeedHint(float backEmfFrac) { _emf = _clamp1_(backEmfFrac); }
+  bool fastDecayActive() const { return _fastDecay; }
   void setSlewRate(float perSec) { _cfg.slewRatePerSec = perSec; }
   void setDeadband(float db) { _cfg.deadband = constrain(db, 0.0f, 0.5f); }
   void setMinOutput(float m) { _cfg.minOutput = constrain(m, 0.0f, 0.95f); }
 
+  // Freno controlado b ∈ [0..1]: solo actúa cuando el mando aplicado es 0
+  // (Sign-Magnitude). b=0 -> neutral configurado; b=1 -> freno pleno.
+  void  setBrake(float b) { _brake = constrain(b, 0.0f, 1.0f); }
+  float brakeCommand() const { return _brake; }
+  bool  braking() const { return _braking; }
+
   // Info PWM
   uint32_t maxDuty() const { return _maxDuty; }
   uint32_t dutyIn1() const { return _lastDutyIn1; }
@@ -77,6 +102,9 @@ private:
   void _writeIn1_(uint32_t d);
   void _writeIn2_(uint32_t d);
   void _neutral_();                 // aplica neutral (coast o brake)
+  void _brakePWM_(float b);         // ambos pines a duty b (short-brake parcial)
+  bool _wantFastDecay_(float u);    // decisión de decay según modo/cuadrante
+  void _writeFastDecay_(float u);   // IN1 = d, IN2 = complemento (hpoint = d)
   static float _applyDeadbandMin_(float x, float deadband, float minOut);
   static float _clamp1_(float x) { return (x < -1.0f ? -1.0f : (x > 1.0f ? 1.0f : x)); }
 
@@ -91,6 +119,14 @@ private:
   // Comando
   float    _uTarget      = 0.0f;
   float    _uApplied     = 0.0f;
+  float    _brake        = 0.0f;   // duty de freno pedido (con u=0)
+  bool     _braking      = false;  // freno PWM aplicado en la última salida
+
+  // Decay
+  bool     _fastOk       = false;  // canales en el mismo timer (hpoint disponible)
+  bool     _fastDecay    = false;  // decay aplicado en la última salida
+  float    _emf          = 0.0f;   // fcem normalizada (hint)
+  bool     _hpoint2      = false;  // IN2 quedó con hpoint != 0 (complementario)
 
   // Estado
   bool     _enabled      = true;
@@ -0,0 +1,101 @@
+#ifndef MULTI_WHEEL_DRIVE_H
+#define MULTI_WHEEL_DRIVE_H
+
+#include <Arduino.h>
+#include "Wheel.h"
+#include "Kinematics.h"
+#include "Ramp.h"
+
+// ============================================================
+// MultiWheelDrive<Kin> — Orquestador genérico de N ruedas
+// - Kin: política de cinemática (kin::Diff2, kin::SkidSteer4, kin::Mecanum4).
+// - Reutiliza Wheel sin cambios: cada rueda recibe su omega_ref.
+// - Rampas por eje (vx, vy, w) con aceleración y deceleración separadas,
+//   igual que DifferentialDrive (Ramp.h); límite de twist y re-escalado
+//   uniforme si alguna rueda supera omegaWheelMax.
+// - El orden de las ruedas en el arreglo es el de la política.
+// - Sin rutinas coordinadas de cal/align (ver DifferentialDrive para 2 ruedas).
+// ============================================================
+template <class Kin>
+class MultiWheelDrive {
+public:
+  static const uint8_t kWheels = Kin::kWheels;
+
+  struct Config {
+    float vMax    = 0.8f;    // [m/s]   |vx| y |vy|
+    float wMax    = 6.0f;    // [rad/s]
+    float vAccMax = 1.5f;    // [m/s^2]   (0 => sin rampa)
+    float wAccMax = 10.0f;   // [rad/s^2]
+    float vDecMax = 0.0f;    // [m/s^2]   (0 => igual que la aceleración)
+    float wDecMax = 0.0f;    // [rad/s^2]
+    float omegaWheelMax = 120.0f;   // [rad/s] (<=0 => desactivado)
+  };
+
+  // wheels: arreglo de kWheels punteros en el orden de Kin
+  MultiWheelDrive(const Config& cfg, const Kin& k, Wheel* const (&wheels)[Kin::kWheels])
+  : _cfg(cfg), _kin(k) {
+    for (uint8_t i=0;i<kWheels;i++) _w[i] = wheels[i];
+  }
+
+  void begin() { for (uint8_t i=0;i<kWheels;i++) _w[i]->begin(); }
+
+  // vy se ignora en políticas no holonómicas
+  void setTwist(float vx, float vy, float w) {
+    _ref[0] = _clamp(vx, -_cfg.vMax, _cfg.vMax);
+    _ref[1] = Kin::kHolonomic ? _clamp(vy, -_cfg.vMax, _cfg.vMax) : 0.0f;
+    _ref[2] = _clamp(w,  -_cfg.wMax, _cfg.wMax);
+  }
+  void stop()    { setTwist(0.0f, 0.0f, 0.0f); }
+  void neutral() { for (uint8_t i=0;i<kWheels;i++) _w[i]->neutral(); }
+
+  void update(float dt_s) {
+    _cmd[0] = ramp::axis(_ref[0], _cmd[0], _cfg.vAccMax, _cfg.vDecMax, dt_s);
+    _cmd[1] = ramp::axis(_ref[1], _cmd[1], _cfg.vAccMax, _cfg.vDecMax, dt_s);
+    _cmd[2] = ramp::axis(_ref[2], _cmd[2], _cfg.wAccMax, _cfg.wDecMax, dt_s);
+
+    _kin.inverse(_cmd[0], _cmd[1], _cmd[2], _om);
+
+    // Re-escalado uniforme: conserva la dirección del twist
+    if (_cfg.omegaWheelMax > 0.0f) {
+      float aMax = 0.0f;
+      for (uint8_t i=0;i<kWheels;i++) aMax = max(aMax, fabsf(_om[i]));
+      if (aMax > _cfg.omegaWheelMax) {
+        const float k = _cfg.omegaWheelMax / aMax;
+        for (uint8_t i=0;i<3;i++) _cmd[i] *= k;
+        for (uint8_t i=0;i<kWheels;i++) _om[i] *= k;
+      }
+    }
+
+    for (uint8_t i=0;i<kWheels;i++) {
+      _w[i]->setOmegaRef(_om[i]);
+      _w[i]->update(dt_s);
+    }
+  }
+
+  // Twist medido (omega de rueda con el signo del mando aplicado)
+  void measuredTwist(float& vx, float& vy, float& w) const {
+    float om[Kin::kWheels];
+    for (uint8_t i=0;i<kWheels;i++) om[i] = (float)_w[i]->signApplied() * _w[i]->omega();
+    _kin.forward(om, vx, vy, w);
+  }
+
+  // Lecturas
+  float vxCmd() const { return _cmd[0]; }
+  float vyCmd() const { return _cmd[1]; }
+  float wCmd()  const { return _cmd[2]; }
+  float omegaCmd(uint8_t i) const { return (i < kWheels) ? _om[i] : 0.0f; }
+  Wheel& wheel(uint8_t i) { return *_w[i]; }
+  const Kin& kinematics() const { return _kin; }
+
+private:
+  static inline float _clamp(float x, float a, float b) { return (x < a) ? a : (x > b) ? b : x; }
+
+  Config  _cfg;
+  Kin     _kin;
+  Wheel*  _w[Kin::kWheels];
+  float   _ref[3] = { 0.0f, 0.0f, 0.0f };   // vx, vy, w pedidos
+  float   _cmd[3] = { 0.0f, 0.0f, 0.0f };   // tras rampas / escalado
+  float   _om[Kin::kWheels];
+};
+
+#endif // MULTI_WHEEL_DRIVE_H
@@ -0,0 +1,115 @@
+#include "OccupancyGrid.h"
+#include <math.h>
+#include <string.h>
+
+OccupancyGrid::OccupancyGrid(const Config& cfg)
+: _cfg(cfg) {
+  if (_cfg.width == 0)  _cfg.width = 1;
+  if (_cfg.height == 0) _cfg.height = 1;
+  if (_cfg.resolution <= 0.0f) _cfg.resolution = 0.05f;
+  _invRes = 1.0f / _cfg.resolution;
+  _tilesX = (uint16_t)((_cfg.width  + (1u << _cfg.tileShift) - 1) >> _cfg.tileShift);
+  _tilesY = (uint16_t)((_cfg.height + (1u << _cfg.tileShift) - 1) >> _cfg.tileShift);
+
+  // La arena no libera por bloque: la instancia vive todo el programa
+  _cells = StaticArena::allocArray<int8_t>((size_t)_cfg.width * _cfg.height, 0);
+  _dirty.n    = (uint32_t)_tilesX * _tilesY;
+  _dirty.bits = StaticArena::allocArray<uint8_t>(_dirty.bytes(), 0);
+}
+
+size_t OccupancyGrid::arenaBytes(const Config& cfg) {
+  const uint32_t ts = 1u << cfg.tileShift;
+  const size_t tiles = (size_t)((cfg.width + ts - 1) / ts) * ((cfg.height + ts - 1) / ts);
+  return (size_t)cfg.width * cfg.height + (tiles + 7) / 8;
+}
+
+void OccupancyGrid::clear() {
+  memset(_cells, 0, (size_t)_cfg.width * _cfg.height);
+  markAllDirty();
+}
+
+// ---------- Inserción ----------
+
+// Libre en todas las celdas del rayo menos la última, que es eco si hit
+struct OccupancyGrid::RayVisit {
+  OccupancyGrid* g;
+  bool hit;
+  inline void operator()(int32_t x, int32_t y, bool last) {
+    g->_update_(x, y, (last && hit) ? g->_cfg.lHit : g->_cfg.lMiss);
+  }
+};
+
+void OccupancyGrid::insertRange(float x, float y, float th, float bearing, float range) {
+  // Sin eco (o fuera de rango): solo espacio libre hasta maxRange
+  const bool hit = (range > 0.0f && range < _cfg.maxRange);
+  const float r = hit ? range : _cfg.maxRange;
+  const float a = th + bearing;
+  insertRay(x, y, x + r * cosf(a), y + r * sinf(a), hit);
+}
+
+void OccupancyGrid::insertRay(float x0, float y0, float x1, float y1, bool hit) {
+  int32_t cx0, cy0;
+  if (!worldToCell(x0, y0, cx0, cy0)) return;        // sensor fuera del mapa
+  // El extremo puede caer fuera: floorf conserva la dirección, el trazado corta en el borde
+  const int32_t cx1 = (int32_t)floorf((x1 - _cfg.originX) * _invRes);
+  const int32_t cy1 = (int32_t)floorf((y1 - _cfg.originY) * _invRes);
+  _st.rays++;
+  RayVisit v = { this, hit };
+  bool clipped;
+  _st.cells += grid::castRay(cx0, cy0, cx1, cy1, _cfg.width, _cfg.height, v, clipped);
+  if (clipped) _st.clipped++;
+}
+
+// ---------- Consultas ----------
+
+bool OccupancyGrid::worldToCell(float x, float y, int32_t& cx, int32_t& cy) const {
+  cx = (int32_t)floorf((x - _cfg.originX) * _invRes);
+  cy = (int32_t)floorf((y - _cfg.originY) * _invRes);
+  return (uint32_t)cx < _cfg.width && (uint32_t)cy < _cfg.height;
+}
+
+void OccupancyGrid::cellToWorld(int32_t cx, int32_t cy, float& x, float& y) const {
+  x = _cfg.originX + (cx + 0.5f) * _cfg.resolution;
+  y = _cfg.originY + (cy + 0.5f) * _cfg.resolution;
+}
+
+OccupancyGrid::State OccupancyGrid::state(int32_t cx, int32_t cy) const {
+  const int8_t l = logOdds(cx, cy);
+  if (l >= _cfg.lOcc)  return Occupied;
+  if (l <= _cfg.lFree) return Free;
+  return Unknown;
+}
+
+OccupancyGrid::State OccupancyGrid::stateAt(float x, float y) const {
+  int32_t cx, cy;
+  return worldToCell(x, y, cx, cy) ? state(cx, cy) : Unknown;
+}
+
+float OccupancyGrid::probability(int32_t cx, int32_t cy) const {
+  const float l = logOdds(cx, cy) * (1.0f / 16.0f);
+  return 1.0f / (1.0f + expf(-l));
+}
+
+uint8_t OccupancyGrid::obstaclesNear(float x, float y, float radius,
+                                     PotentialField::Obstacle* out, uint8_t max) const {
+  return grid::obstaclesNear(*this, x, y, radius, out, max);
+}
+
+// ---------- Tiles sucios ----------
+
+bool OccupancyGrid::tileDirty(uint16_t tx, uint16_t ty) const {
+  return _dirty.test((uint32_t)ty * _tilesX + tx);
+}
+
+uint32_t OccupancyGrid::dirtyCount() const { return _dirty.count(); }
+
+bool OccupancyGrid::takeDirty(uint32_t& cursor, uint16_t& tx, uint16_t& ty) {
+  uint32_t t;
+  if (!_dirty.take(cursor, t)) return false;
+  tx = (uint16_t)(t % _tilesX);
+  ty = (uint16_t)(t / _tilesX);
+  return true;
+}
+
+void OccupancyGrid::clearDirty()   { _dirty.clear(); }
+void OccupancyGrid::markAllDirty() { _dirty.setAll(); }
@@ -0,0 +1,116 @@
+#ifndef OCCUPANCY_GRID_H
+#define OCCUPANCY_GRID_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "StaticArena.h"
+#include "PotentialField.h"
+#include "GridOps.h"
+
+// ============================================================
+// OccupancyGrid — Mapa de ocupación en log-odds int8
+// - Celda = log-odds cuantizado en int8 con saturación [lMin, lMax]
+//   (0 = desconocido). Sumas en int16 y recorte: sin coma flotante por celda.
+// - insertRange(): lectura de un sensor de distancia desde la pose del robot.
+//   Rayo por Bresenham entero: celdas atravesadas += lMiss, celda final
+//   += lHit (solo si la lectura es un eco < maxRange). El extremo se recorta
+//   a maxRange; un rayo que sale del mapa se corta en el borde.
+// - Regiones sucias: bit por tile (2^tileShift celdas de lado) que se marca
+//   solo si alguna celda cambió de valor (saturada no cuenta), para que una
+//   transformada de distancia posterior recalcule solo esos tiles.
+// - Memoria desde StaticArena en el constructor (ver arenaBytes()): la Config
+//   por defecto (128x128) ocupa ~16 KiB. Dimensionado de STATIC_ARENA_BYTES:
+//   ver StaticArena.h.
+// - C++ puro: mismo código en el robot y en host.
+// ============================================================
+class OccupancyGrid {
+public:
+  struct Config {
+    uint16_t width      = 128;     // [celdas]
+    uint16_t height     = 128;
+    float    resolution = 0.05f;   // [m/celda]
+    float    originX    = -3.2f;   // [m] esquina (0,0) del mapa en el mundo
+    float    originY    = -3.2f;
+
+    // Log-odds en unidades de 1/16 nat (int8: ±8 nat)
+    int8_t   lHit       = 14;      // ~ p=0.70 por eco
+    int8_t   lMiss      = -6;      // ~ p=0.40 por paso libre
+    int8_t   lMin       = -64;     // saturación (libre muy seguro, reversible)
+    int8_t   lMax       = 64;
+    int8_t   lOcc       = 24;      // >= ocupado
+    int8_t   lFree      = -12;     // <= libre
+
+    float    maxRange   = 2.0f;    // [m] lecturas >= esto = sin eco
+    uint8_t  tileShift  = 4;       // tiles de 16x16
+  };
+
+  enum State : uint8_t { Unknown = 0, Free, Occupied };
+
+  struct Stats {
+    uint32_t rays  = 0;
+    uint32_t cells = 0;            // celdas actualizadas
+    uint32_t clipped = 0;          // rayos cortados en el borde del mapa
+  };
+
+  explicit OccupancyGrid(const Config& cfg);
+
+  // Bytes de StaticArena que consume una instancia con esta Config
+  static size_t arenaBytes(const Config& cfg);
+
+  // --- Inserción ---
+  // Sensor en (x, y) del robot con rumbo th; bearing relativo al robot
+  void insertRange(float x, float y, float th, float bearing, float range);
+  // Rayo del mundo (x0,y0)->(x1,y1); hit: la celda final es un eco
+  void insertRay(float x0, float y0, float x1, float y1, bool hit);
+  void clear();
+
+  // --- Consultas ---
+  bool    worldToCell(float x, float y, int32_t& cx, int32_t& cy) const;  // false si fuera
+  void    cellToWorld(int32_t cx, int32_t cy, float& x, float& y) const;  // centro de la celda
+  int8_t  logOdds(int32_t cx, int32_t cy) const { return _cells[(size_t)cy * _cfg.width + cx]; }
+  State   state(int32_t cx, int32_t cy) const;
+  State   stateAt(float x, float y) const;      // fuera del mapa = Unknown
+  float   probability(int32_t cx, int32_t cy) const;
+
+  // Celdas ocupadas a menos de radius de (x, y) como repulsores de
+  // PotentialField (las max más cercanas). Devuelve cuántas.
+  uint8_t obstaclesNear(float x, float y, float radius, PotentialField::Obstacle* out, uint8_t max) const;
+
+  // --- Tiles sucios ---
+  uint16_t tilesX() const { return _tilesX; }
+  uint16_t tilesY() const { return _tilesY; }
+  uint16_t tileSize() const { return (uint16_t)(1u << _cfg.tileShift); }
+  bool     tileDirty(uint16_t tx, uint16_t ty) const;
+  uint32_t dirtyCount() const;
+  // Siguiente tile sucio a partir de *cursor (recorrido por filas) y lo limpia.
+  // Empezar con cursor = 0; false cuando no quedan.
+  bool     takeDirty(uint32_t& cursor, uint16_t& tx, uint16_t& ty);
+  void     clearDirty();
+  void     markAllDirty();
+
+  const Config& config() const { return _cfg; }
+  const Stats&  stats()  const { return _st; }
+  const int8_t* data()   const { return _cells; }   // fila a fila, width x height
+
+private:
+  inline void _update_(int32_t cx, int32_t cy, int8_t dl) {
+    int8_t& c = _cells[(size_t)cy * _cfg.width + cx];
+    int16_t v = (int16_t)c + dl;
+    if (v < _cfg.lMin) v = _cfg.lMin;
+    if (v > _cfg.lMax) v = _cfg.lMax;
+    if (v != c) {
+      c = (int8_t)v;
+      _dirty.set((uint32_t)(cy >> _cfg.tileShift) * _tilesX + (uint32_t)(cx >> _cfg.tileShift));
+    }
+  }
+  struct RayVisit;    // visitante de grid::castRay
+
+  Config   _cfg;
+  float    _invRes;
+  uint16_t _tilesX, _tilesY;
+  int8_t*  _cells;
+  grid::TileBits _dirty;    // 1 bit por tile
+  Stats    _st;
+};
+
+#endif // OCCUPANCY_GRID_H
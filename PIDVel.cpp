@@ -31,11 +31,27 @@ void PIDVel::_recomputeInternals() {
     _computePI_TustinCoeffs();
   }
 
+  // Caché de Ts variable (parte de Ts nominal)
+  _halfKi = 0.5f * _cfg.Ki;
+  _dt     = (_cfg.Ts > 1e-9f) ? _cfg.Ts : 1e-3f;
+  _invDt  = 1.0f / _dt;
+
   PID_LOGF("[PID] Recompute: Kp=%.6f Ki=%.6f Kd=%.6f Tf=%.6f Ts=%.6f alpha=%.6f mode=%d\n",
            (double)_cfg.Kp, (double)_cfg.Ki, (double)_cfg.Kd,
            (double)_cfg.Tf, (double)_cfg.Ts, (double)_alpha, (int)_mode);
 }
 
+void PIDVel::_retime(float dt) {
+  // Mismas fórmulas que _recomputeInternals/_computePI_TustinCoeffs, solo lo que depende de dt:
+  //   c0 = Kp + Ki*dt/2 ; c1 = -Kp + Ki*dt/2 ; alpha = dt/(Tf+dt)
+  _dt    = dt;
+  _invDt = 1.0f / dt;
+  const float kiH = _halfKi * dt;
+  _c0 =  _cfg.Kp + kiH;
+  _c1 = -_cfg.Kp + kiH;
+  _alpha = (_cfg.Tf > 0.0f) ? dt / (_cfg.Tf + dt) : 1.0f;
+}
+
 // ======================== Constructores =========================
 // (Corregido) Sin argumento por defecto en la declaración del .h
 PIDVel::PIDVel(const Config& cfg) : _cfg(cfg) {
@@ -78,10 +94,19 @@ void PIDVel::reset(float u0) {
   _y = _y1 = 0.0f;
   _dY = _dY1 = 0.0f;
   _uPid = _uSat = _clamp(u0, _cfg.uMin, _cfg.uMax);
+  _I = _uSat;   // bumpless: con e=0 y dY=0 la salida arranca en u0
 }
 
-// r, y son magnitudes (no negativas); el signo lo maneja el caller (tu .ino)
 float PIDVel::update(float r, float y) {
+  return update(r, y, _cfg.Ts);
+}
+
+// r, y son magnitudes (no negativas); el signo lo maneja el caller (tu .ino)
+// dt: periodo real desde la muestra anterior [s]; si no es válido se usa Ts.
+float PIDVel::update(float r, float y, float dt) {
+  if (!(dt > 1e-9f)) dt = (_cfg.Ts > 1e-9f) ? _cfg.Ts : 1e-3f;
+  if (dt != _dt) _retime(dt);
+
   // Estado actual
   _y = y;
   _e = r - y;
@@ -102,22 +127,21 @@ float PIDVel::update(float r, float y) {
     _uSat = _clamp(u_new, _cfg.uMin, _cfg.uMax);
 
   } else { // PIDF_Tustin (paralelo con derivada de la medida filtrada)
-    // Derivada filtrada de la medida
-    const float dy = _y - _y1;
+    // Derivada filtrada de la medida (en tasa, válida con dt variable)
+    const float dy = (_y - _y1) * _invDt;
     const float dY = (1.0f - _alpha)*_dY1 + _alpha*dy;
 
     // Integral por trapecios y proporcional/derivativo en paralelo
-    const float Ts = (_cfg.Ts > 1e-9f) ? _cfg.Ts : 1e-3f;
-    static float I = 0.0f;
+    float& I = _I;
 
     // Integración con anti-windup básico (stop-integrator al saturar y empujar)
     float P = _cfg.Kp * _e;
-    float D = (_cfg.Tf > 0.0f || _alpha < 1.0f) ? (-_cfg.Kd * dY / Ts) : 0.0f; // derivada sobre la medida
+    float D = (_cfg.Tf > 0.0f || _alpha < 1.0f) ? (-_cfg.Kd * dY) : 0.0f; // derivada sobre la medida
 
     float u_pre = P + I + D;
 
     // Probar saturación hipotética después de integrar
-    float I_candidate = I + _cfg.Ki * (Ts*0.5f) * (_e + _e1);
+    float I_candidate = I + _halfKi * _dt * (_e + _e1);
     float u_candidate = P + I_candidate + D;
 
     if (_antiWindup) {
@@ -36,7 +36,8 @@ public:
 
   // === Operación ===
   void  reset(float u0 = 0.0f);
-  float update(float r, float y);
+  float update(float r, float y);            // usa Ts nominal
+  float update(float r, float y, float dt);  // usa dt medido [s] (Ts variable)
 
   // === Getters ===
   float u()    const { return _uSat; }
@@ -62,15 +63,21 @@ private:
   float _uPid=0;                  // salida "pura" del calculador (antes de sat.)
   float _uSat=0;                  // salida saturada
 
-  // Derivada filtrada (PIDF_Tustin): dY[k] = (1-alpha)*dY[k-1] + alpha*(y[k]-y[k-1])
+  // Derivada filtrada (PIDF_Tustin), en tasa: dY[k] = (1-alpha)*dY[k-1] + alpha*(y[k]-y[k-1])/dt
   float _dY=0, _dY1=0;
-  float _alpha=0;                // Ts/(Tf+Ts)
+  float _alpha=0;                // dt/(Tf+dt)
+  float _I=0;                    // integrador (PIDF_Tustin)
 
   // Coeficientes incrementales (modo PI_Tustin)
   float _c0=0, _c1=0, _c2=0;     // con PI_Tustin: c2=0
 
+  // Caché para Ts variable: coeficientes válidos para _dt (evita _recomputeInternals)
+  float _dt=0, _invDt=0;         // dt de los coeficientes actuales y 1/dt
+  float _halfKi=0;               // Ki/2
+
   // Helpers
   void  _recomputeInternals();
   void  _computePI_TustinCoeffs();
+  void  _retime(float dt);       // recalcula solo términos dependientes de dt
   float _clamp(float v, float a, float b) const { return (v<b)?((v>a)?v:a):b; }
 };
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include "PIDVel.h"
+
+// ============================================================
+// PIDVelQ — PI incremental (Tustin) en punto fijo Q16.16
+// - Misma interfaz que PIDVel para WheelT (Config, reset, update(r,y,dt), u()).
+// - Ganancias y estados enteros; dt en us -> coeficientes sin división en
+//   punto flotante. Entradas/salida en float solo en la frontera.
+// - Solo PI (Kd/Tf se ignoran); el estado es la salida saturada (anti-windup).
+// ============================================================
+class PIDVelQ {
+public:
+  typedef PIDVel::Config Config;
+
+  explicit PIDVelQ(const Config& cfg) : _cfg(cfg) {
+    _kp     = _toQ(cfg.Kp);
+    _halfKi = _toQ(0.5f * cfg.Ki);
+    _uMin   = _toQ(cfg.uMin);
+    _uMax   = _toQ(cfg.uMax);
+    _retime((uint32_t)((cfg.Ts > 1e-6f ? cfg.Ts : 1e-3f) * 1.0e6f));
+  }
+  PIDVelQ() : PIDVelQ(Config()) {}
+
+  inline void reset(float u0 = 0.0f) {
+    _e1 = 0;
+    _u  = _clampQ(_toQ(u0));
+  }
+
+  inline float update(float r, float y) { return update(r, y, _cfg.Ts); }
+
+  inline float update(float r, float y, float dt) {
+    const uint32_t dtUs = (dt > 1e-6f) ? (uint32_t)(dt * 1.0e6f) : _dtUs;
+    if (dtUs != _dtUs) _retime(dtUs);
+
+    const int32_t e = _toQ(r - y);
+    // u += c0·e + c1·e1 (productos Q16·Q16 en 64 bits)
+    int64_t u = (int64_t)_u + (((int64_t)_c0 * e + (int64_t)_c1 * _e1) >> 16);
+    if (u > _uMax) u = _uMax;
+    if (u < _uMin) u = _uMin;
+    _u  = (int32_t)u;
+    _e1 = e;
+    return u_();
+  }
+
+  inline float u() const { return u_(); }
+
+private:
+  static inline int32_t _toQ(float x) { return (int32_t)(x * 65536.0f); }
+  inline float   u_() const { return (float)_u * (1.0f / 65536.0f); }
+  inline int32_t _clampQ(int32_t v) const { return (v < _uMin) ? _uMin : (v > _uMax) ? _uMax : v; }
+
+  inline void _retime(uint32_t dtUs) {
+    // c0 = Kp + Ki·dt/2 ; c1 = -Kp + Ki·dt/2   (Q16)
+    _dtUs = dtUs;
+    const int32_t kiH = (int32_t)(((int64_t)_halfKi * dtUs) / 1000000LL);
+    _c0 =  _kp + kiH;
+    _c1 = -_kp + kiH;
+  }
+
+  Config   _cfg;
+  int32_t  _kp = 0, _halfKi = 0;
+  int32_t  _c0 = 0, _c1 = 0;
+  int32_t  _uMin = 0, _uMax = 65536;
+  int32_t  _u = 0, _e1 = 0;
+  uint32_t _dtUs = 0;
+};
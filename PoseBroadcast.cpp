@@ -0,0 +1,286 @@
+#include "PoseBroadcast.h"
+#include "Kinematics.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include "lwip/sockets.h"
+  #define PB_LOGF(fmt, ...) do { if (_log) _log->printf(fmt, ##__VA_ARGS__); } while(0)
+#else
+  #include <sys/socket.h>
+  #include <netinet/in.h>
+  #include <arpa/inet.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #define PB_LOGF(fmt, ...) do { (void)_log; } while(0)
+#endif
+
+// ============================================================
+// Paquete (24 B, little-endian)
+//   0 magia 'P''B' | 2 versión | 3 id | 4 seq u16 | 6 tMs u32
+//  10 x mm i32 | 14 y mm i32 | 18 th i16 (pi = 32768) | 20 v mm/s i16 | 22 w mrad/s i16
+// ============================================================
+static const uint8_t kMagic0 = 'P', kMagic1 = 'B', kVersion = 1;
+static const float   kThScale = 32768.0f / (float)M_PI;
+
+static inline void _put16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void _put32(uint8_t* p, uint32_t v) { _put16(p, (uint16_t)v); _put16(p + 2, (uint16_t)(v >> 16)); }
+static inline uint16_t _get16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t _get32(const uint8_t* p) { return (uint32_t)_get16(p) | ((uint32_t)_get16(p + 2) << 16); }
+
+static inline int32_t _sat(float x, float lo, float hi) {
+  return (int32_t)lroundf((x < lo) ? lo : (x > hi) ? hi : x);
+}
+
+void PoseBroadcast::encode(uint8_t* p, uint8_t id, uint16_t seq, uint32_t tMs,
+                           float x, float y, float th, float v, float w) {
+  p[0] = kMagic0; p[1] = kMagic1; p[2] = kVersion; p[3] = id;
+  _put16(p + 4, seq);
+  _put32(p + 6, tMs);
+  _put32(p + 10, (uint32_t)_sat(x * 1000.0f, -2.0e9f, 2.0e9f));
+  _put32(p + 14, (uint32_t)_sat(y * 1000.0f, -2.0e9f, 2.0e9f));
+  _put16(p + 18, (uint16_t)_sat(kin::wrapPi(th) * kThScale, -32768.0f, 32767.0f));
+  _put16(p + 20, (uint16_t)_sat(v * 1000.0f, -32768.0f, 32767.0f));
+  _put16(p + 22, (uint16_t)_sat(w * 1000.0f, -32768.0f, 32767.0f));
+}
+
+bool PoseBroadcast::decode(const uint8_t* p, uint8_t n, uint8_t& id, uint16_t& seq, uint32_t& tMs,
+                           float& x, float& y, float& th, float& v, float& w) {
+  if (n != kPacketBytes || p[0] != kMagic0 || p[1] != kMagic1 || p[2] != kVersion || p[3] == 0) return false;
+  id  = p[3];
+  seq = _get16(p + 4);
+  tMs = _get32(p + 6);
+  x   = (float)(int32_t)_get32(p + 10) * 1e-3f;
+  y   = (float)(int32_t)_get32(p + 14) * 1e-3f;
+  th  = (float)(int16_t)_get16(p + 18) / kThScale;
+  v   = (float)(int16_t)_get16(p + 20) * 1e-3f;
+  w   = (float)(int16_t)_get16(p + 22) * 1e-3f;
+  return true;
+}
+
+// ============================================================
+// Backend de sockets (lwIP y POSIX comparten la API BSD)
+// ============================================================
+
+static int _sockOpen(const char* group, uint16_t port, uint8_t ttl, bool localhost) {
+  const int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (s < 0) return -1;
+
+  int one = 1;
+  setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+  setsockopt(s, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));   // varios procesos, mismo puerto
+#endif
+
+  struct sockaddr_in a;
+  memset(&a, 0, sizeof(a));
+  a.sin_family      = AF_INET;
+  a.sin_port        = htons(port);
+  a.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(s, (struct sockaddr*)&a, sizeof(a)) < 0) { close(s); return -1; }
+
+  struct in_addr ifAddr;
+  ifAddr.s_addr = localhost ? inet_addr("127.0.0.1") : htonl(INADDR_ANY);
+
+  struct ip_mreq mr;
+  mr.imr_multiaddr.s_addr = inet_addr(group);
+  mr.imr_interface        = ifAddr;
+  if (setsockopt(s, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mr, sizeof(mr)) < 0) { close(s); return -1; }
+
+  uint8_t t = ttl, loop = localhost ? 1 : 0;   // en la flota real el eco propio sobra
+  setsockopt(s, IPPROTO_IP, IP_MULTICAST_TTL,  &t,    sizeof(t));
+  setsockopt(s, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+  if (localhost) setsockopt(s, IPPROTO_IP, IP_MULTICAST_IF, &ifAddr, sizeof(ifAddr));
+
+  fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+
+  return s;
+}
+
+static bool _sockSend(int h, const char* group, uint16_t port, const uint8_t* buf, uint8_t n) {
+  // Sin connect(): en un socket UDP conectado solo se reciben datagramas del
+  // destino, y los vecinos llegan desde su IP unicast
+  struct sockaddr_in dst;
+  memset(&dst, 0, sizeof(dst));
+  dst.sin_family      = AF_INET;
+  dst.sin_port        = htons(port);
+  dst.sin_addr.s_addr = inet_addr(group);
+  return sendto(h, buf, n, 0, (struct sockaddr*)&dst, sizeof(dst)) == (int)n;
+}
+
+static int _sockRecv(int h, uint8_t* buf, uint8_t cap) {
+  const int n = (int)recv(h, buf, cap, 0);
+  return (n < 0) ? -1 : n;
+}
+
+static void _sockClose(int h) { close(h); }
+
+PoseBroadcast::Backend PoseBroadcast::defaultBackend() {
+  Backend be;
+  be.open  = _sockOpen;
+  be.send  = _sockSend;
+  be.recv  = _sockRecv;
+  be.close = _sockClose;
+  return be;
+}
+
+// ============================================================
+// PoseBroadcast
+// ============================================================
+
+PoseBroadcast::PoseBroadcast(const Config& cfg) : PoseBroadcast(cfg, defaultBackend()) {}
+
+PoseBroadcast::PoseBroadcast(const Config& cfg, const Backend& be) : _cfg(cfg), _be(be) {
+  for (uint8_t i=0;i<kMaxNeighbors;i++) {
+    _slots[i].seq.store(0, std::memory_order_relaxed);
+    _slots[i].id = 0;
+    _slots[i].lastSeq = 0;
+    _slots[i].rxUs = 0;
+    _slots[i].x = _slots[i].y = _slots[i].th = _slots[i].v = _slots[i].w = 0.0f;
+  }
+}
+
+PoseBroadcast::~PoseBroadcast() { end(); }
+
+bool PoseBroadcast::begin() {
+  end();
+  _h = _be.open(_cfg.group, _cfg.port, _cfg.ttl, _cfg.localhost);
+  _nextTxUs = Timebase::nowUs();
+  PB_LOGF("[PB] %s  id=%u grupo=%s:%u  %.1f Hz\n", (_h >= 0) ? "begin" : "ERROR socket",
+          (unsigned)_cfg.id, _cfg.group, (unsigned)_cfg.port, (double)_cfg.rateHz);
+  return _h >= 0;
+}
+
+void PoseBroadcast::end() {
+  if (_h >= 0) _be.close(_h);
+  _h = -1;
+}
+
+// ---------- Envío / recepción ----------
+
+void PoseBroadcast::update(float x, float y, float th, float v, float w) {
+  const uint64_t now = Timebase::nowUs();
+  if (_cfg.rateHz > 0.0f && (int64_t)(now - _nextTxUs) >= 0) {
+    publish(x, y, th, v, w);
+    const uint64_t period = (uint64_t)(1.0e6f / _cfg.rateHz);
+    _nextTxUs += period;
+    if ((int64_t)(now - _nextTxUs) >= 0) _nextTxUs = now + period;   // sin ráfagas tras un hueco
+  }
+  poll();
+}
+
+void PoseBroadcast::publish(float x, float y, float th, float v, float w) {
+  if (_h < 0) return;
+  uint8_t p[kPacketBytes];
+  encode(p, _cfg.id, _txSeq++, Timebase::nowMs(), x, y, th, v, w);
+  if (_be.send(_h, _cfg.group, _cfg.port, p, kPacketBytes)) _st.tx++;
+}
+
+void PoseBroadcast::poll() {
+  if (_h < 0) return;
+  uint8_t buf[kPacketBytes + 8];   // mayor que el paquete: un datagrama largo no pasa por válido
+  int n;
+  while ((n = _be.recv(_h, buf, sizeof(buf))) >= 0) {
+    uint8_t id; uint16_t seq; uint32_t tMs;
+    float x, y, th, v, w;
+    if (!decode(buf, (uint8_t)n, id, seq, tMs, x, y, th, v, w)) { _st.bad++; continue; }
+    if (id == _cfg.id) { _st.own++; continue; }
+
+    const uint64_t now = Timebase::nowUs();
+    Slot* s = _slotFor_(id, now);
+    if (!s) { _st.full++; continue; }
+
+    const bool known = (s->id == id) && (now - s->rxUs <= (uint64_t)_cfg.maxAgeMs * 1000ULL);
+    if (known) {
+      const int16_t gap = (int16_t)(seq - s->lastSeq);
+      if (gap <= 0) continue;                       // duplicado o desordenado
+      _st.lost += (uint32_t)(gap - 1);
+    }
+
+    // Seqlock: impar mientras se escribe
+    const uint32_t q = s->seq.load(std::memory_order_relaxed);
+    s->seq.store(q + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s->id = id;
+    s->lastSeq = seq;
+    s->rxUs = now;
+    s->x = x; s->y = y; s->th = th; s->v = v; s->w = w;
+    s->seq.store(q + 2, std::memory_order_release);
+    _st.rx++;
+    (void)tMs;   // relojes de robots distintos no comparables: la edad cuenta desde la recepción
+  }
+}
+
+PoseBroadcast::Slot* PoseBroadcast::_slotFor_(uint8_t id, uint64_t nowUs) {
+  // Mismo id -> su ranura; si no, una libre o caducada
+  Slot* freeSlot = nullptr;
+  const uint64_t maxAgeUs = (uint64_t)_cfg.maxAgeMs * 1000ULL;
+  for (uint8_t i=0;i<kMaxNeighbors;i++) {
+    Slot& s = _slots[i];
+    if (s.id == id) return &s;
+    if (!freeSlot && (s.id == 0 || nowUs - s.rxUs > maxAgeUs)) freeSlot = &s;
+  }
+  return freeSlot;
+}
+
+// ---------- Lectores ----------
+
+bool PoseBroadcast::_read_(const Slot& s, NeighborPose& out, uint64_t nowUs) const {
+  // Reintentos acotados: si el escritor quedó expropiado a mitad (mismo
+  // núcleo, menor prioridad) el vecino se omite este ciclo en vez de girar
+  uint64_t rxUs = 0;
+  bool ok = false;
+  for (uint8_t tries = 0; tries < 8 && !ok; tries++) {
+    const uint32_t q0 = s.seq.load(std::memory_order_acquire);
+    if (q0 & 1u) continue;                          // escritor a mitad
+    out.id = s.id;
+    out.x = s.x; out.y = s.y; out.th = s.th; out.v = s.v; out.w = s.w;
+    rxUs = s.rxUs;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    ok = (s.seq.load(std::memory_order_relaxed) == q0);
+  }
+  if (!ok || out.id == 0 || nowUs < rxUs) return false;
+  const uint64_t age = nowUs - rxUs;
+  if (age > (uint64_t)_cfg.maxAgeMs * 1000ULL) return false;
+  out.ageMs = (uint32_t)(age / 1000ULL);
+  return true;
+}
+
+uint8_t PoseBroadcast::neighbors(NeighborPose* out, uint8_t max) const {
+  const uint64_t now = Timebase::nowUs();
+  uint8_t n = 0;
+  for (uint8_t i=0;i<kMaxNeighbors && n<max;i++) {
+    if (_read_(_slots[i], out[n], now)) n++;
+  }
+  return n;
+}
+
+uint8_t PoseBroadcast::repulsors(float x, float y, PotentialField::Obstacle* out, uint8_t max) const {
+  const uint64_t now = Timebase::nowUs();
+  uint8_t n = 0;
+  for (uint8_t i=0;i<kMaxNeighbors && n<max;i++) {
+    NeighborPose p;
+    if (!_read_(_slots[i], p, now)) continue;
+
+    // Arco de twist constante desde la recepción: t = edad (ahora) y edad + predictS
+    const float tNow = p.ageMs * 1e-3f;
+    const float ts[2] = { tNow, tNow + _cfg.predictS };
+    const uint8_t nT = (_cfg.predictS > 0.0f && (fabsf(p.v) > 0.01f || fabsf(p.w) > 0.01f)) ? 2 : 1;
+    for (uint8_t k=0;k<nT && n<max;k++) {
+      const float t = ts[k];
+      float px, py;
+      if (fabsf(p.w) < 1e-3f) {
+        px = p.x + p.v * t * cosf(p.th);
+        py = p.y + p.v * t * sinf(p.th);
+      } else {
+        const float R = p.v / p.w, th1 = p.th + p.w * t;
+        px = p.x + R * (sinf(th1) - sinf(p.th));
+        py = p.y - R * (cosf(th1) - cosf(p.th));
+      }
+      if (hypotf(px - x, py - y) > _cfg.range) continue;
+      out[n].x = px; out[n].y = py; out[n].r = _cfg.robotRadius;
+      n++;
+    }
+  }
+  return n;
+}
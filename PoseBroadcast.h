@@ -0,0 +1,120 @@
+#ifndef POSE_BROADCAST_H
+#define POSE_BROADCAST_H
+
+#include <stdint.h>
+#include <atomic>
+#include "Timebase.h"
+#include "PotentialField.h"
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include <Arduino.h>
+#else
+  class Stream;
+#endif
+
+// ============================================================
+// PoseBroadcast — Pose propia por UDP multicast + tabla de vecinos
+// - Sin servidor: cada robot publica su pose de odometría y su twist a
+//   ritmo fijo (paquete binario de 24 B, little-endian) y escucha el grupo.
+// - Tabla de vecinos de tamaño fijo, un escritor (poll) y lectores sin
+//   bloqueo (seqlock por ranura): el planificador lee desde otra tarea sin
+//   esperar nunca al receptor.
+// - Entradas más viejas que maxAgeMs se ignoran (robot apagado o fuera).
+// - repulsors(): cada vecino -> repulsor en su pose extrapolada a "ahora" y
+//   otro a predictS segundos con su v/w (arco de twist constante).
+// - Backend por punteros a función: sockets BSD (lwIP en ESP32, POSIX en
+//   host). En host, localhost=true fija la interfaz 127.0.0.1 con loop
+//   multicast: varios procesos en la misma máquina hacen de flota.
+// ============================================================
+class PoseBroadcast {
+public:
+  static const uint8_t kMaxNeighbors = 16;
+  static const uint8_t kPacketBytes  = 24;
+
+  struct Backend {
+    // Devuelve un manejador (>=0) o -1
+    int  (*open)(const char* group, uint16_t port, uint8_t ttl, bool localhost);
+    bool (*send)(int h, const char* group, uint16_t port, const uint8_t* buf, uint8_t n);
+    // No bloquea: bytes leídos o -1 si no hay nada
+    int  (*recv)(int h, uint8_t* buf, uint8_t cap);
+    void (*close)(int h);
+  };
+
+  struct Config {
+    uint8_t     id          = 1;            // único por robot (0 = sin asignar)
+    const char* group       = "239.255.77.1";
+    uint16_t    port        = 47700;
+    uint8_t     ttl         = 1;            // no sale de la subred
+    bool        localhost   = false;        // host: flota de procesos locales
+    float       rateHz      = 20.0f;        // publicación
+    uint32_t    maxAgeMs    = 500;          // vecino caducado
+    float       robotRadius = 0.12f;        // [m] radio de los vecinos
+    float       predictS    = 0.5f;         // [s] horizonte de predicción (0 = solo actual)
+    float       range       = 2.0f;         // [m] solo vecinos a menos de esto
+  };
+
+  struct NeighborPose {
+    uint8_t  id;
+    float    x, y, th;     // [m], [rad]
+    float    v, w;         // [m/s], [rad/s]
+    uint32_t ageMs;
+  };
+
+  struct Stats {
+    uint32_t tx = 0, rx = 0;
+    uint32_t bad = 0;      // tamaño/magia/versión incorrectos
+    uint32_t own = 0;      // eco propio (loop multicast)
+    uint32_t lost = 0;     // huecos de secuencia
+    uint32_t full = 0;     // tabla llena: vecino descartado
+  };
+
+  explicit PoseBroadcast(const Config& cfg);
+  PoseBroadcast(const Config& cfg, const Backend& be);
+  ~PoseBroadcast();
+
+  static Backend defaultBackend();   // sockets de la plataforma
+
+  bool begin();
+  void end();
+
+  // Llamar en el lazo con la pose propia: publica si toca y drena recepción
+  void update(float x, float y, float th, float v, float w);
+  void publish(float x, float y, float th, float v, float w);
+  void poll();                       // único escritor de la tabla
+
+  // Lectores (cualquier tarea, sin bloqueo)
+  uint8_t neighbors(NeighborPose* out, uint8_t max) const;
+  uint8_t repulsors(float x, float y, PotentialField::Obstacle* out, uint8_t max) const;
+
+  const Stats& stats() const { return _st; }
+  void setLog(Stream* s) { _log = s; }
+
+  // Codificación (pública para herramientas y simulación)
+  static void encode(uint8_t* p, uint8_t id, uint16_t seq, uint32_t tMs,
+                     float x, float y, float th, float v, float w);
+  static bool decode(const uint8_t* p, uint8_t n, uint8_t& id, uint16_t& seq, uint32_t& tMs,
+                     float& x, float& y, float& th, float& v, float& w);
+
+private:
+  struct Slot {
+    std::atomic<uint32_t> seq;     // impar = escribiendo
+    uint8_t  id;                   // 0 = libre (solo lo toca el escritor)
+    uint16_t lastSeq;
+    uint64_t rxUs;
+    float    x, y, th, v, w;
+  };
+
+  bool  _read_(const Slot& s, NeighborPose& out, uint64_t nowUs) const;
+  Slot* _slotFor_(uint8_t id, uint64_t nowUs);
+
+  Config   _cfg;
+  Backend  _be;
+  int      _h = -1;
+  uint16_t _txSeq = 0;
+  uint64_t _nextTxUs = 0;
+  Slot     _slots[kMaxNeighbors];
+  Stats    _st;
+  Stream*  _log = nullptr;
+};
+
+#endif // POSE_BROADCAST_H
@@ -0,0 +1,85 @@
+#include "PotentialField.h"
+
+bool PotentialField::addObstacle(float x, float y, float r) {
+  if (_nObs >= kMaxObstacles) return false;
+  _obs[_nObs].x = x; _obs[_nObs].y = y; _obs[_nObs].r = r;
+  _nObs++;
+  return true;
+}
+
+float PotentialField::clearance(float x, float y) const {
+  float c = 1.0e9f;
+  for (uint8_t i=0;i<_nObs;i++) {
+    const float d = hypotf(x - _obs[i].x, y - _obs[i].y) - _obs[i].r - _cfg.robotRadius;
+    if (d < c) c = d;
+  }
+  return c;
+}
+
+void PotentialField::force(float x, float y, float& fx, float& fy,
+                           const Obstacle* nb, uint8_t nNb) const {
+  // Atracción lineal, saturada a attMax
+  float ax = _cfg.kAtt * (_gx - x), ay = _cfg.kAtt * (_gy - y);
+  const float aN = hypotf(ax, ay);
+  if (aN > _cfg.attMax && aN > 0.0f) { ax *= _cfg.attMax / aN; ay *= _cfg.attMax / aN; }
+
+  // Repulsión atenuada a menos de rInfluence de la meta (meta junto a un
+  // obstáculo alcanzable)
+  float rx = 0.0f, ry = 0.0f;
+  const float gScale = _clamp(hypotf(_gx - x, _gy - y) / _cfg.rInfluence, 0.0f, 1.0f);
+  for (uint8_t i=0;i<_nObs;i++) _repel_(x, y, _obs[i], gScale, rx, ry);
+  for (uint8_t i=0;i<nNb;i++)   _repel_(x, y, nb[i],   gScale, rx, ry);
+
+  // Sesgo lateral: repulsión girada +90 grados (de frente queda a la derecha)
+  if (_cfg.sideBias != 0.0f) {
+    const float bx = -_cfg.sideBias * ry, by = _cfg.sideBias * rx;
+    rx += bx; ry += by;
+  }
+
+  fx = ax + rx;
+  fy = ay + ry;
+
+  // Mínimo local: empuje tangencial hacia el lado del objetivo
+  const float rN = hypotf(rx, ry);
+  if (rN > 0.0f && aN > 0.0f && hypotf(fx, fy) < _cfg.stallRatio * ((aN < _cfg.attMax) ? aN : _cfg.attMax)) {
+    float tx = -ry / rN, ty = rx / rN;
+    if (tx * (_gx - x) + ty * (_gy - y) < 0.0f) { tx = -tx; ty = -ty; }
+    const float k = _cfg.tangentGain * _cfg.attMax;
+    fx += k * tx;
+    fy += k * ty;
+  }
+}
+
+void PotentialField::_repel_(float x, float y, const Obstacle& o, float scale,
+                             float& rx, float& ry) const {
+  // Khatib: kRep·(1/d - 1/rho0)/d² en la normal, d = distancia a la superficie
+  const float dx = x - o.x, dy = y - o.y;
+  const float dc = hypotf(dx, dy);
+  if (dc <= 1e-6f) return;
+  float d = dc - o.r - _cfg.robotRadius;
+  if (d >= _cfg.rInfluence) return;
+  if (d < 1e-3f) d = 1e-3f;
+  const float mag = scale * _cfg.kRep * (1.0f / d - 1.0f / _cfg.rInfluence) / (d * d);
+  rx += mag * dx / dc;
+  ry += mag * dy / dc;
+}
+
+bool PotentialField::twist(float x, float y, float theta, float& v, float& w,
+                           const Obstacle* nb, uint8_t nNb) const {
+  if (reached(x, y)) { v = 0.0f; w = 0.0f; return true; }
+
+  float fx, fy;
+  force(x, y, fx, fy, nb, nNb);
+
+  // Objetivo casi detrás: sentido de giro fijo (evita alternar ±wMax en ±pi)
+  float e = kin::wrapPi(atan2f(fy, fx) - theta);
+  if (e < -0.9f * (float)M_PI) e += 2.0f * (float)M_PI;
+  w = _clamp(_cfg.kHeading * e, -_cfg.wMax, _cfg.wMax);
+
+  // Solo avanza si la fuerza apunta hacia delante; frena dentro de slowRadius
+  const float c = cosf(e);
+  float slow = 1.0f;
+  if (_cfg.slowRadius > 0.0f) slow = _clamp(hypotf(_gx - x, _gy - y) / _cfg.slowRadius, 0.0f, 1.0f);
+  v = (c > 0.0f) ? _cfg.vMax * c * slow : 0.0f;
+  return false;
+}
@@ -0,0 +1,84 @@
+#ifndef POTENTIAL_FIELD_H
+#define POTENTIAL_FIELD_H
+
+#include <stdint.h>
+#include <math.h>
+#include "Kinematics.h"
+
+// ============================================================
+// PotentialField — Planificador reactivo por campos de potencial
+// - C++ puro (sin Arduino): el mismo código corre en el robot y en host.
+// - Atracción lineal al objetivo (saturada) + repulsión de Khatib de
+//   obstáculos circulares dentro de rInfluence (distancia a la superficie
+//   menos el radio del robot), atenuada cerca de la meta.
+// - Mínimos locales: si atracción y repulsión casi se anulan se añade una
+//   componente tangencial (rodea el obstáculo por el lado del objetivo).
+// - twist(): fuerza -> (v, w) de un diferencial: w persigue el rumbo de la
+//   fuerza, v escala con cos(error de rumbo) y frena cerca del objetivo.
+// - Tabla fija de obstáculos (sin heap); los móviles se pasan por llamada.
+// ============================================================
+class PotentialField {
+public:
+  struct Config {
+    float kAtt        = 1.0f;    // [1/s] ganancia de atracción
+    float attMax      = 1.0f;    // saturación de la atracción
+    float kRep        = 0.02f;   // ganancia de repulsión
+    float rInfluence  = 0.30f;   // [m] alcance de la repulsión (desde la superficie)
+    float robotRadius = 0.12f;   // [m]
+    float tangentGain = 0.5f;    // componente tangencial en mínimos locales
+    float stallRatio  = 0.25f;   // |F| < stallRatio·|Fatt| => mínimo local
+    float sideBias    = 0.0f;    // repulsión girada a la derecha (·|Frep|): cruces
+                                 // de robots de frente se resuelven por la derecha
+
+    float vMax        = 0.40f;   // [m/s]
+    float wMax        = 3.0f;    // [rad/s]
+    float kHeading    = 3.0f;    // [1/s] w = kHeading·error de rumbo
+    float slowRadius  = 0.25f;   // [m] rampa de v al acercarse
+    float goalTol     = 0.03f;   // [m]
+  };
+
+  struct Obstacle { float x, y, r; };
+  static const uint8_t kMaxObstacles = 16;
+
+  explicit PotentialField(const Config& cfg) : _cfg(cfg) {}
+
+  void setGoal(float x, float y) { _gx = x; _gy = y; }
+  float goalX() const { return _gx; }
+  float goalY() const { return _gy; }
+
+  bool addObstacle(float x, float y, float r);   // false si la tabla está llena
+  void clearObstacles() { _nObs = 0; }
+  uint8_t obstacleCount() const { return _nObs; }
+  const Obstacle& obstacle(uint8_t i) const { return _obs[i]; }
+
+  // Fuerza total en (x, y) (marco del mundo). nb: repulsores extra de este
+  // instante (p.ej. robots vecinos como círculos de su radio), sin copiarlos.
+  void  force(float x, float y, float& fx, float& fy,
+              const Obstacle* nb = nullptr, uint8_t nNb = 0) const;
+
+  // Holgura mínima a obstáculos [m] (<0 => colisión); muy grande si no hay
+  float clearance(float x, float y) const;
+
+  bool  reached(float x, float y) const {
+    return hypotf(_gx - x, _gy - y) <= _cfg.goalTol;
+  }
+
+  // Twist (v, w) desde la pose; true si ya está en el objetivo (v=w=0)
+  bool  twist(float x, float y, float theta, float& v, float& w,
+              const Obstacle* nb = nullptr, uint8_t nNb = 0) const;
+
+  const Config& config() const { return _cfg; }
+
+private:
+  static inline float _clamp(float x, float a, float b) {
+    return (x < a) ? a : (x > b) ? b : x;
+  }
+  void _repel_(float x, float y, const Obstacle& o, float scale, float& rx, float& ry) const;
+
+  Config   _cfg;
+  float    _gx = 0.0f, _gy = 0.0f;
+  Obstacle _obs[kMaxObstacles];
+  uint8_t  _nObs = 0;
+};
+
+#endif // POTENTIAL_FIELD_H
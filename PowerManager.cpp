@@ -0,0 +1,220 @@
+#include "PowerManager.h"
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include "esp_sleep.h"
+  #include "driver/gpio.h"
+  #include "driver/uart.h"
+  #if CONFIG_PM_ENABLE
+    #include "esp_pm.h"
+  #endif
+  #define PM_LOGF(fmt, ...) do { if (_log) _log->printf(fmt, ##__VA_ARGS__); } while(0)
+#else
+  #define PM_LOGF(fmt, ...) do { (void)_log; } while(0)
+#endif
+
+// ============================================================
+// Backends
+// ============================================================
+
+// ---------- Host: registra y, con reloj virtual, avanza el tiempo ----------
+PowerManager::HostStats& PowerManager::hostStats() {
+  static HostStats s;
+  return s;
+}
+
+static bool _hostSetMhz(uint32_t mhz) {
+  PowerManager::HostStats& s = PowerManager::hostStats();
+  s.setCalls++;
+  s.mhz = mhz;
+  return true;
+}
+
+static uint32_t _hostMhz() { return PowerManager::hostStats().mhz; }
+
+static uint64_t _hostLightSleep(uint64_t maxUs, const int8_t*, uint8_t, bool) {
+  PowerManager::HostStats& s = PowerManager::hostStats();
+  const uint64_t now = Timebase::nowUs();
+  uint64_t dur = maxUs;
+  // Flanco simulado (rueda empujada / comando) antes del timer
+  if (s.wakeAtUs > now && s.wakeAtUs - now < dur) dur = s.wakeAtUs - now;
+  if (Timebase::isVirtual()) Timebase::advanceUs(dur);
+  s.sleeps++;
+  s.sleptUs += dur;
+  return dur;
+}
+
+PowerManager::Backend PowerManager::hostBackend() {
+  Backend be;
+  be.setCpuMhz  = _hostSetMhz;
+  be.cpuMhz     = _hostMhz;
+  be.lightSleep = _hostLightSleep;
+  return be;
+}
+
+// ---------- ESP32 ----------
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+
+#if CONFIG_PM_ENABLE
+// Con PM habilitado: max_freq = nivel pedido y un lock CPU_FREQ_MAX retenido
+// (la CPU se queda en ese máximo; el light sleep lo gestiona PowerManager).
+static esp_pm_lock_handle_t s_cpuLock = nullptr;
+static uint32_t             s_pmMhz   = 240;
+
+static bool _espSetMhz(uint32_t mhz) {
+  if (!s_cpuLock) {
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "pmgr", &s_cpuLock) != ESP_OK) return false;
+    esp_pm_lock_acquire(s_cpuLock);
+  }
+  esp_pm_config_esp32_t c;
+  c.max_freq_mhz = (int)mhz;
+  c.min_freq_mhz = (mhz < 80) ? (int)mhz : 80;
+  c.light_sleep_enable = false;
+  if (esp_pm_configure(&c) != ESP_OK) return false;
+  s_pmMhz = mhz;
+  return true;
+}
+static uint32_t _espMhz() { return s_pmMhz; }
+#else
+// Sin PM en sdkconfig (Arduino por defecto): cambio directo de reloj
+static bool     _espSetMhz(uint32_t mhz) { return setCpuFrequencyMhz(mhz); }
+static uint32_t _espMhz()                { return getCpuFrequencyMhz(); }
+#endif
+
+static uint64_t _espLightSleep(uint64_t maxUs, const int8_t* pins, uint8_t nPins, bool uartWake) {
+  // PCNT se detiene en light sleep (APB apagado): se despierta por GPIO en el
+  // nivel contrario al actual del sensor; ese primer flanco puede no contarse.
+  esp_sleep_enable_timer_wakeup(maxUs);
+  for (uint8_t i=0;i<nPins;i++) {
+    const gpio_num_t p = (gpio_num_t)pins[i];
+    gpio_wakeup_enable(p, gpio_get_level(p) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+  }
+  if (nPins) esp_sleep_enable_gpio_wakeup();
+  if (uartWake) {
+    uart_set_wakeup_threshold(UART_NUM_0, 3);
+    esp_sleep_enable_uart_wakeup(0);
+  }
+
+  const uint64_t t0 = Timebase::nowUs();   // esp_timer se compensa tras el sueño
+  esp_light_sleep_start();
+  const uint64_t slept = Timebase::nowUs() - t0;
+
+  for (uint8_t i=0;i<nPins;i++) gpio_wakeup_disable((gpio_num_t)pins[i]);
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+  return slept;
+}
+
+PowerManager::Backend PowerManager::targetBackend() {
+  Backend be;
+  be.setCpuMhz  = _espSetMhz;
+  be.cpuMhz     = _espMhz;
+  be.lightSleep = _espLightSleep;
+  return be;
+}
+
+PowerManager::Backend PowerManager::defaultBackend() { return targetBackend(); }
+
+#else
+
+PowerManager::Backend PowerManager::targetBackend()  { return hostBackend(); }
+PowerManager::Backend PowerManager::defaultBackend() { return hostBackend(); }
+
+#endif
+
+// ============================================================
+// PowerManager
+// ============================================================
+
+PowerManager::PowerManager(const Config& cfg) : PowerManager(cfg, defaultBackend()) {}
+
+PowerManager::PowerManager(const Config& cfg, const Backend& be) : _cfg(cfg), _be(be) {
+  if (_cfg.nLevels == 0) _cfg.nLevels = 1;
+  if (_cfg.nLevels > kMaxLevels) _cfg.nLevels = kMaxLevels;
+}
+
+void PowerManager::begin() {
+  _level = 0;
+  _be.setCpuMhz(_cfg.freqMhz[0]);
+  _winStartUs = _idleSinceUs = Timebase::nowUs();
+  _busyUs = 0; _maxBusyUs = 0;
+  PM_LOGF("[PM] begin  %lu MHz  levels=%u  sleep=%d\n",
+          (unsigned long)_be.cpuMhz(), (unsigned)_cfg.nLevels, _cfg.lightSleep ? 1 : 0);
+}
+
+void PowerManager::loopBegin() {
+  const uint64_t now = Timebase::nowUs();
+  if (_prevStartUs != 0) {
+    const uint32_t per = (uint32_t)(now - _prevStartUs);
+    // Deadline perdido (ciclo > 1.5 periodos): al máximo sin esperar a la ventana
+    if (_periodUs > 0 && per > _periodUs + (_periodUs >> 1)) {
+      _missed++;
+      if (_level != 0) {
+        PM_LOGF("[PM] deadline miss (%lu us) -> max\n", (unsigned long)per);
+        _setLevel_(0);
+      }
+    }
+    _periodUs = (_periodUs == 0) ? per : (uint32_t)((7ULL * _periodUs + per) / 8ULL);
+  }
+  _prevStartUs = now;
+  _loopStartUs = now;
+}
+
+void PowerManager::loopEnd() {
+  if (_loopStartUs == 0) return;
+  const uint32_t busy = (uint32_t)(Timebase::nowUs() - _loopStartUs);
+  _busyUs += busy;
+  if (busy > _maxBusyUs) _maxBusyUs = busy;
+}
+
+void PowerManager::update(bool driveIdle, uint64_t nextDeadlineUs) {
+  const uint64_t now = Timebase::nowUs();
+  if (now - _winStartUs >= _cfg.windowUs) _closeWindow_(now);
+
+  // ---- Light sleep en reposo ----
+  if (!driveIdle || !_cfg.lightSleep) { _idleSinceUs = now; return; }
+  if (now - _idleSinceUs < (uint64_t)_cfg.idleBeforeSleepMs * 1000ULL) return;
+  if (nextDeadlineUs <= now + _cfg.wakeLatencyUs) return;
+
+  const uint64_t span = nextDeadlineUs - now - _cfg.wakeLatencyUs;
+  if (span < _cfg.minSleepUs) return;
+
+  uint8_t nPins = 0;
+  int8_t pins[kMaxWakePins];
+  for (uint8_t i=0;i<kMaxWakePins;i++) if (_cfg.wakePins[i] >= 0) pins[nPins++] = _cfg.wakePins[i];
+
+  const uint64_t slept = _be.lightSleep(span, pins, nPins, _cfg.uartWake);
+  _sleeps++;
+  _sleptUs += slept;
+  // El sueño no es trabajo: la ventana sigue midiendo solo loopBegin/loopEnd
+}
+
+void PowerManager::_closeWindow_(uint64_t nowUs) {
+  const uint64_t win = nowUs - _winStartUs;
+  _util = (win > 0) ? (float)_busyUs / (float)win : 0.0f;
+
+  if (_util > _cfg.utilUp && _level != 0) {
+    PM_LOGF("[PM] util %.2f -> max\n", (double)_util);
+    _setLevel_(0);
+  } else if (_util < _cfg.utilDown && _level + 1 < _cfg.nLevels && _periodUs > 0) {
+    // Proyección a la frecuencia siguiente: el peor ciclo debe seguir cabiendo
+    const float k = (float)_cfg.freqMhz[_level] / (float)_cfg.freqMhz[_level + 1];
+    const float worst = (float)_maxBusyUs * k / (float)_periodUs;
+    if (_util * k < _cfg.utilTarget && worst < _cfg.utilTarget) {
+      PM_LOGF("[PM] util %.2f (peor %.2f @%lu MHz) -> baja\n",
+              (double)_util, (double)worst, (unsigned long)_cfg.freqMhz[_level + 1]);
+      _setLevel_(_level + 1);
+    }
+  }
+
+  _winStartUs = nowUs;
+  _busyUs = 0;
+  _maxBusyUs = 0;
+}
+
+void PowerManager::_setLevel_(uint8_t lvl) {
+  if (lvl >= _cfg.nLevels) lvl = _cfg.nLevels - 1;
+  if (!_be.setCpuMhz(_cfg.freqMhz[lvl])) {
+    PM_LOGF("[PM] setCpuMhz(%lu) falló\n", (unsigned long)_cfg.freqMhz[lvl]);
+    return;
+  }
+  _level = lvl;
+}
@@ -0,0 +1,122 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include "Timebase.h"
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include <Arduino.h>
+#else
+  class Stream;
+#endif
+
+// ============================================================
+// PowerManager — Escalado de CPU según carga + light sleep en reposo
+// - Mide la utilización del lazo de control (loopBegin/loopEnd) por ventana.
+// - Baja un nivel de frecuencia solo si el peor ciclo, escalado a la nueva
+//   frecuencia, sigue cabiendo en el periodo con margen; sube de golpe al
+//   máximo si la carga o un deadline perdido lo piden.
+// - Robot quieto (driveIdle) durante idleBeforeSleepMs -> light sleep entre
+//   ticks, acotado por el próximo deadline menos la latencia de despertar.
+//   Despierta por timer, flanco en pines (encoders) o UART (comandos).
+// - Backend por punteros a función: ESP32 (esp_pm / setCpuFrequencyMhz +
+//   esp_light_sleep_start) o stand-in de host que registra las llamadas.
+// ============================================================
+class PowerManager {
+public:
+  static const uint8_t kMaxLevels   = 4;
+  static const uint8_t kMaxWakePins = 4;
+
+  struct Backend {
+    bool     (*setCpuMhz)(uint32_t mhz);
+    uint32_t (*cpuMhz)();
+    // Duerme hasta maxUs o hasta un flanco en pins / UART. Devuelve us dormidos.
+    uint64_t (*lightSleep)(uint64_t maxUs, const int8_t* pins, uint8_t nPins, bool uartWake);
+  };
+
+  // Registro del stand-in de host (también útil para pruebas en target)
+  struct HostStats {
+    uint32_t setCalls  = 0;
+    uint32_t mhz       = 240;
+    uint32_t sleeps    = 0;
+    uint64_t sleptUs   = 0;
+    uint64_t wakeAtUs  = 0;   // >0: un "flanco" despierta en este instante (Timebase)
+  };
+
+  struct Config {
+    // Niveles de frecuencia, de mayor a menor
+    uint32_t freqMhz[kMaxLevels] = { 240, 160, 80, 0 };
+    uint8_t  nLevels       = 3;
+
+    // Utilización (fracción del periodo ocupada por el lazo)
+    float    utilUp        = 0.60f;   // por encima -> máximo
+    float    utilDown      = 0.30f;   // por debajo -> intenta bajar un nivel
+    float    utilTarget    = 0.50f;   // peor ciclo proyectado al nivel nuevo <= esto
+    uint32_t windowUs      = 500000;  // ventana de medida
+
+    // Light sleep
+    bool     lightSleep        = true;
+    uint32_t idleBeforeSleepMs = 2000;
+    uint32_t wakeLatencyUs     = 1500;  // margen antes del deadline
+    uint32_t minSleepUs        = 3000;  // no dormir tramos más cortos
+    int8_t   wakePins[kMaxWakePins] = { -1, -1, -1, -1 };   // p.ej. pines de encoder
+    bool     uartWake          = true;
+  };
+
+  explicit PowerManager(const Config& cfg);
+  PowerManager(const Config& cfg, const Backend& be);
+
+  static Backend defaultBackend();   // target o host según plataforma
+  static Backend targetBackend();
+  static Backend hostBackend();
+  static HostStats& hostStats();
+
+  void begin();
+
+  // Medida del lazo de control (envolver solo el trabajo, no la espera)
+  void loopBegin();
+  void loopEnd();
+
+  // Una vez por ciclo tras loopEnd(): escala frecuencia y, si procede, duerme
+  // hasta nextDeadlineUs (Timebase) menos la latencia de despertar.
+  void update(bool driveIdle, uint64_t nextDeadlineUs);
+
+  // Lecturas
+  float    utilization() const { return _util; }
+  uint32_t cpuMhz()      const { return _cfg.freqMhz[_level]; }
+  uint8_t  level()       const { return _level; }
+  uint32_t missedDeadlines() const { return _missed; }
+  uint32_t sleepCount()  const { return _sleeps; }
+  uint64_t sleptUs()     const { return _sleptUs; }
+
+  void setLog(Stream* s) { _log = s; }
+
+private:
+  void _setLevel_(uint8_t lvl);
+  void _closeWindow_(uint64_t nowUs);
+
+private:
+  Config   _cfg;
+  Backend  _be;
+
+  uint8_t  _level      = 0;
+
+  // Medida
+  uint64_t _winStartUs = 0;
+  uint64_t _busyUs     = 0;
+  uint32_t _maxBusyUs  = 0;   // peor ciclo de la ventana
+  uint32_t _periodUs   = 0;   // periodo del lazo (EMA)
+  uint64_t _loopStartUs = 0;
+  uint64_t _prevStartUs = 0;
+  float    _util       = 0.0f;
+  uint32_t _missed     = 0;
+
+  // Reposo
+  uint64_t _idleSinceUs = 0;
+  uint32_t _sleeps     = 0;
+  uint64_t _sleptUs    = 0;
+
+  Stream*  _log = nullptr;
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,32 @@
+#ifndef RAMP_H
+#define RAMP_H
+
+#include <math.h>
+
+// ============================================================
+// Ramp — Limitador de aceleración por eje (header-only, sin Arduino)
+// - Mismo criterio en firmware (DifferentialDrive) y en el simulador (sim/).
+// - acc <= 0 => sin rampa; dec <= 0 => dec = acc.
+// - Mientras |cmd| baja manda dec; si el paso cruza 0 se detiene en 0 ese tick.
+// ============================================================
+namespace ramp {
+
+inline float axis(float ref, float cmd, float acc, float dec, float dt) {
+  if (acc <= 0.0f) return ref;                 // sin rampa
+  if (dec <= 0.0f) dec = acc;
+
+  const float d = ref - cmd;
+  const bool slowing = (cmd > 0.0f && d < 0.0f) || (cmd < 0.0f && d > 0.0f);
+  const float step = (slowing ? dec : acc) * dt;
+
+  float out = ref;
+  if (d >  step) out = cmd + step;
+  else if (d < -step) out = cmd - step;
+
+  if (slowing && out * cmd < 0.0f) out = 0.0f;
+  return out;
+}
+
+} // namespace ramp
+
+#endif // RAMP_H
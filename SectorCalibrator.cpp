@@ -9,6 +9,7 @@ static inline size_t idx2D(uint16_t k, uint8_t lap, uint16_t ppr) {
 #define SC_LOGF(fmt, ...) do { if (_log) _log->printf(fmt, ##__VA_ARGS__); } while(0)
 
 SectorCalibrator::SectorCalibrator(const Config& cfg) : _cfg(cfg) {
+  if (_cfg.maxLaps > kMaxLaps) _cfg.maxLaps = kMaxLaps;
   _alloc();
 }
 
@@ -16,43 +17,82 @@ SectorCalibrator::~SectorCalibrator() {
   _free();
 }
 
+static inline uint8_t fourierKEff(const SectorCalibrator::Config& cfg) {
+  // Fourier: K limitado a (ppr-1)/2 para que el ajuste LS sea la proyección DFT
+  const uint8_t kMax = (uint8_t)min((int)(cfg.ppr - 1) / 2, 255);
+  return (cfg.fourierK < kMax) ? cfg.fourierK : kMax;
+}
+
+size_t SectorCalibrator::arenaBytes(const Config& cfg) {
+  const size_t nSectors = (size_t)cfg.ppr;
+  const size_t nCells   = nSectors * (size_t)((cfg.maxLaps < kMaxLaps) ? cfg.maxLaps : kMaxLaps);
+  const uint8_t K       = fourierKEff(cfg);
+  const size_t nCoef    = K ? 2u * K + 1u : 0u;
+  // + holgura de alineación por bloque (9 bloques de 4/2/1 B, alineados a 4)
+  return sizeof(float) * (5 * nSectors + 2 * nCells + 2 * nCoef)
+       + sizeof(bool) * nCells + sizeof(uint16_t) * nSectors + 9 * 4;
+}
+
 void SectorCalibrator::_alloc() {
   const size_t nSectors = (size_t)_cfg.ppr;
   const size_t nCells   = nSectors * (size_t)_cfg.maxLaps;
 
-  _lutFwd   = new float[nSectors];
-  _lutRev   = new float[nSectors];
-  _patFwd   = new float[nSectors];
-  _patRev   = new float[nSectors];
-  _dtBuf    = new float[nCells];
-  _dtFilled = new bool [nCells];
-  _alignBuf = new float[nCells];
-
-  for (uint16_t k=0;k<_cfg.ppr;k++) { _lutFwd[k] = 1.0f; _lutRev[k] = 1.0f; }
+  _lutFwd     = StaticArena::allocArray<float>(nSectors, 1.0f);
+  _lutRev     = StaticArena::allocArray<float>(nSectors, 1.0f);
+  _patFwd     = StaticArena::allocArray<float>(nSectors);
+  _patRev     = StaticArena::allocArray<float>(nSectors);
+  _dtBuf      = StaticArena::allocArray<float>(nCells);
+  _dtFilled   = StaticArena::allocArray<bool>(nCells, false);
+  _alignBuf   = StaticArena::allocArray<float>(nCells);
+  _sectorMean = StaticArena::allocArray<float>(nSectors);
+  _votes      = StaticArena::allocArray<uint16_t>(nSectors);
+
+  _fouK = fourierKEff(_cfg);
+  if (_fouK > 0) {
+    const size_t nCoef = 2u * _fouK + 1u;
+    _fouFwd = StaticArena::allocArray<float>(nCoef);
+    _fouRev = StaticArena::allocArray<float>(nCoef);
+    _fouFwd[0] = _fouRev[0] = 1.0f;
+  }
 }
 
 void SectorCalibrator::_free() {
-  delete[] _lutFwd;   _lutFwd = nullptr;
-  delete[] _lutRev;   _lutRev = nullptr;
-  delete[] _patFwd;   _patFwd = nullptr;
-  delete[] _patRev;   _patRev = nullptr;
-  delete[] _dtBuf;    _dtBuf = nullptr;
-  delete[] _dtFilled; _dtFilled = nullptr;
-  delete[] _alignBuf; _alignBuf = nullptr;
+  // La arena no libera por bloque: la instancia vive todo el programa
+  _lutFwd = _lutRev = _patFwd = _patRev = nullptr;
+  _dtBuf = _alignBuf = _sectorMean = nullptr;
+  _dtFilled = nullptr;
+  _votes = nullptr;
+  _fouFwd = _fouRev = nullptr;
 }
 
 // ---------------- Persistencia ----------------
 void SectorCalibrator::load() {
+  StaticArena::HeapAllowScope nvs;   // NVS asigna internamente
   _prefs.begin(_cfg.nvsNamespace, true);
 
   // Intentar leer dual
   const size_t need = (size_t)_cfg.ppr * sizeof(float);
 
-  bool haveFwd = _prefs.isKey(_cfg.nvsKeyLutFwd) && _prefs.getBytesLength(_cfg.nvsKeyLutFwd) == need;
-  bool haveRev = _prefs.isKey(_cfg.nvsKeyLutRev) && _prefs.getBytesLength(_cfg.nvsKeyLutRev) == need;
+  bool haveFwd = false;
+  bool haveRev = false;
 
-  if (haveFwd) _prefs.getBytes(_cfg.nvsKeyLutFwd, _lutFwd, need);
-  if (haveRev) _prefs.getBytes(_cfg.nvsKeyLutRev, _lutRev, need);
+  // Con modelo de Fourier se prefieren los coeficientes; si no, la LUT (y viceversa).
+  // _patFwd/_patRev sirven de buffer temporal: se reconstruyen al final de load().
+  const bool fouFirst = (_fouK > 0);
+  if (fouFirst) {
+    haveFwd = _loadFourier(_cfg.nvsKeyFouFwd, _lutFwd, _patFwd);
+    haveRev = _loadFourier(_cfg.nvsKeyFouRev, _lutRev, _patRev);
+  }
+  if (!haveFwd && _prefs.isKey(_cfg.nvsKeyLutFwd) && _prefs.getBytesLength(_cfg.nvsKeyLutFwd) == need) {
+    haveFwd = (_prefs.getBytes(_cfg.nvsKeyLutFwd, _lutFwd, need) == need);
+  }
+  if (!haveRev && _prefs.isKey(_cfg.nvsKeyLutRev) && _prefs.getBytesLength(_cfg.nvsKeyLutRev) == need) {
+    haveRev = (_prefs.getBytes(_cfg.nvsKeyLutRev, _lutRev, need) == need);
+  }
+  if (!fouFirst) {
+    if (!haveFwd) haveFwd = _loadFourier(_cfg.nvsKeyFouFwd, _lutFwd, _patFwd);
+    if (!haveRev) haveRev = _loadFourier(_cfg.nvsKeyFouRev, _lutRev, _patRev);
+  }
 
   // Flags y offsets
   _useFwd = _prefs.getBool(_cfg.nvsKeyUseFwd, _cfg.useLUTByDefault);
@@ -82,12 +122,19 @@ void SectorCalibrator::load() {
 
   _prefs.end();
 
+  // Modelo de Fourier: la LUT en uso es siempre la serie (también si venía una LUT completa)
+  if (_fouK > 0) {
+    _fitFourier(_lutFwd, _fouFwd); _evalFourier(_fouFwd, _fouK, _lutFwd);
+    _fitFourier(_lutRev, _fouRev); _evalFourier(_fouRev, _fouK, _lutRev);
+  }
+
   // Construye patrones
   _buildPatternFromLUT_Fwd();
   _buildPatternFromLUT_Rev();
 }
 
 void SectorCalibrator::save() {
+  StaticArena::HeapAllowScope nvs;   // NVS asigna internamente
   _prefs.begin(_cfg.nvsNamespace, false);
 
   const size_t need = (size_t)_cfg.ppr * sizeof(float);
@@ -95,8 +142,21 @@ void SectorCalibrator::save() {
   _prefs.putBool(_cfg.nvsKeyUseRev, _useRev);
   _prefs.putUShort(_cfg.nvsKeyOffFwd, _offFwd);
   _prefs.putUShort(_cfg.nvsKeyOffRev, _offRev);
-  _prefs.putBytes(_cfg.nvsKeyLutFwd, _lutFwd, need);
-  _prefs.putBytes(_cfg.nvsKeyLutRev, _lutRev, need);
+  if (_fouK > 0) {
+    // Solo 2K+1 coeficientes por sentido; la LUT se reconstruye al cargar
+    _fitFourier(_lutFwd, _fouFwd);
+    _fitFourier(_lutRev, _fouRev);
+    const size_t nCoefBytes = (2u * _fouK + 1u) * sizeof(float);
+    _prefs.putBytes(_cfg.nvsKeyFouFwd, _fouFwd, nCoefBytes);
+    _prefs.putBytes(_cfg.nvsKeyFouRev, _fouRev, nCoefBytes);
+    if (_prefs.isKey(_cfg.nvsKeyLutFwd)) _prefs.remove(_cfg.nvsKeyLutFwd);
+    if (_prefs.isKey(_cfg.nvsKeyLutRev)) _prefs.remove(_cfg.nvsKeyLutRev);
+  } else {
+    _prefs.putBytes(_cfg.nvsKeyLutFwd, _lutFwd, need);
+    _prefs.putBytes(_cfg.nvsKeyLutRev, _lutRev, need);
+    if (_prefs.isKey(_cfg.nvsKeyFouFwd)) _prefs.remove(_cfg.nvsKeyFouFwd);
+    if (_prefs.isKey(_cfg.nvsKeyFouRev)) _prefs.remove(_cfg.nvsKeyFouRev);
+  }
 
   _prefs.end();
 
@@ -144,6 +204,53 @@ void SectorCalibrator::_buildPatternFromLUT_Rev() {
   SC_LOGF("[PATTERN REV] ready=%d (range=%.6f)\n", _patRevReady?1:0, (double)(maxv - minv));
 }
 
+// ---------------- Fourier ----------------
+void SectorCalibrator::_fitFourier(const float* lut, float* coef) const {
+  // Mínimos cuadrados de s[k] ≈ a0 + Σ_h a_h cos(2πhk/N) + b_h sin(2πhk/N).
+  // Con k uniforme en una vuelta y h < N/2 la base es ortogonal:
+  //   a0 = mean(s), a_h = (2/N) Σ s_k cos(.), b_h = (2/N) Σ s_k sin(.)
+  const uint16_t N = _cfg.ppr;
+  const float w0 = 2.0f * PI / (float)N;
+  float sum = 0.0f;
+  for (uint16_t k=0;k<N;k++) sum += lut[k];
+  coef[0] = sum / (float)N;
+  for (uint8_t h=1; h<=_fouK; h++) {
+    float a=0.0f, b=0.0f;
+    for (uint16_t k=0;k<N;k++) {
+      const float ph = w0 * (float)((h * (uint32_t)k) % N);
+      a += lut[k] * cosf(ph);
+      b += lut[k] * sinf(ph);
+    }
+    coef[2*h-1] = 2.0f * a / (float)N;
+    coef[2*h]   = 2.0f * b / (float)N;
+  }
+}
+
+void SectorCalibrator::_evalFourier(const float* coef, uint8_t K, float* lut) const {
+  const uint16_t N = _cfg.ppr;
+  const float w0 = 2.0f * PI / (float)N;
+  for (uint16_t k=0;k<N;k++) {
+    float v = coef[0];
+    for (uint8_t h=1; h<=K; h++) {
+      const float ph = w0 * (float)((h * (uint32_t)k) % N);
+      v += coef[2*h-1] * cosf(ph) + coef[2*h] * sinf(ph);
+    }
+    lut[k] = v;
+  }
+}
+
+bool SectorCalibrator::_loadFourier(const char* key, float* lut, float* scratch) {
+  // Acepta cualquier K guardado (longitud impar de floats, 2K+1 <= ppr)
+  if (!_prefs.isKey(key)) return false;
+  const size_t len = _prefs.getBytesLength(key);
+  if (len == 0 || (len % sizeof(float)) != 0) return false;
+  const size_t nCoef = len / sizeof(float);
+  if ((nCoef % 2) == 0 || nCoef > _cfg.ppr) return false;
+  if (_prefs.getBytes(key, scratch, len) != len) return false;
+  _evalFourier(scratch, (uint8_t)((nCoef - 1) / 2), lut);
+  return true;
+}
+
 // ---------------- Calibración ----------------
 bool SectorCalibrator::startCalibrationDir(uint8_t lapsN, int stepDir) {
   if (lapsN==0 || lapsN>_cfg.maxLaps) return false;
@@ -197,16 +304,31 @@ bool SectorCalibrator::finishCalibrationIfReady() {
   if (!_calibActive) return false;
   if (_calibLap < _calibTargetN) return false;
 
+  // Referencia por vuelta: periodo esperado en el sector k de la vuelta j
+  //   ref(k,j) = m_j + slope_j * (pos(k) - (ppr-1)/2)
+  // con pos(k) el orden temporal del sector en la vuelta (ver _lapTimePos)
+  // (normalizeLaps=false -> ref=1, promedia periodos crudos como antes)
+  float lapMean[kMaxLaps], lapSlope[kMaxLaps];
+  const bool norm = _cfg.normalizeLaps;
+  if (norm) _lapReference(lapMean, lapSlope);
+  const float kMid = 0.5f * (float)(_cfg.ppr - 1);
+
   // media por sector (con trimming)
-  float* sectorMean = new float[_cfg.ppr];
+  float* sectorMean = _sectorMean;
   float globalSum = 0.0f; uint32_t globalCount = 0;
 
   for (uint16_t k=0;k<_cfg.ppr;k++) {
-    float tmp[16]; // maxLaps<=12
+    float tmp[kMaxLaps];
     uint8_t n=0;
     for (uint8_t j=0;j<_calibTargetN;j++) {
       const size_t id = idx2D(k,j,_cfg.ppr);
-      if (_dtFilled[id]) tmp[n++] = _dtBuf[id];
+      if (!_dtFilled[id]) continue;
+      if (norm) {
+        const float ref = lapMean[j] + lapSlope[j] * (_lapTimePos(k) - kMid);
+        if (ref > 0.0f) tmp[n++] = _dtBuf[id] / ref;
+      } else {
+        tmp[n++] = _dtBuf[id];
+      }
     }
     float mk = (n>0) ? _trimmedMean(tmp, n) : 0.0f;
     sectorMean[k] = mk;
@@ -223,6 +345,15 @@ bool SectorCalibrator::finishCalibrationIfReady() {
       if (mk <= 0.0f) mk = globalMean;
       lut[k] = globalMean / mk; // s[k] = mean / sectorMean
     }
+    // Modelo de Fourier: la LUT en uso es la serie ajustada (filtra ruido de pocas vueltas)
+    if (_fouK > 0) {
+      float* coef = (_modeDir>=0) ? _fouFwd : _fouRev;
+      _fitFourier(lut, coef);
+      _evalFourier(coef, _fouK, lut);
+    }
+    // La LUT nueva está indexada en el marco de sectores actual -> offset 0
+    if (_modeDir>=0) _offFwd = 0;
+    else             _offRev = 0;
     // Estadísticas rápidas
     float minv=1e9f, maxv=-1e9f, sum=0.f;
     for (uint16_t k=0;k<_cfg.ppr;k++) {
@@ -242,11 +373,42 @@ bool SectorCalibrator::finishCalibrationIfReady() {
             (_modeDir>=0)?"FWD":"REV", (double)minv,(double)maxv,(double)mean);
   }
 
-  delete[] sectorMean;
   _calibActive = false;
   return ok;
 }
 
+void SectorCalibrator::_lapReference(float* lapMean, float* lapSlope) const {
+  // Media de cada vuelta completa; las incompletas (1ª vuelta si no arrancó en k=0)
+  // heredan la de la vuelta completa vecina para no sesgarse con el patrón.
+  bool full[kMaxLaps];
+  for (uint8_t j=0;j<_calibTargetN;j++) {
+    float sum=0.0f; uint16_t cnt=0;
+    for (uint16_t k=0;k<_cfg.ppr;k++) {
+      const size_t id = idx2D(k,j,_cfg.ppr);
+      if (_dtFilled[id]) { sum += _dtBuf[id]; cnt++; }
+    }
+    full[j]    = (cnt == _cfg.ppr);
+    lapMean[j] = (cnt > 0) ? sum / (float)cnt : 0.0f;
+  }
+  for (uint8_t j=0;j<_calibTargetN;j++) {
+    if (full[j]) continue;
+    if (j+1 < _calibTargetN && full[j+1]) lapMean[j] = lapMean[j+1];
+    else if (j > 0 && full[j-1])          lapMean[j] = lapMean[j-1];
+  }
+
+  // Deriva lineal dentro de la vuelta, estimada con las medias de vueltas vecinas
+  // (diferencia central) para no confundirla con el propio patrón de imanes.
+  const float invPpr = 1.0f / (float)_cfg.ppr;
+  for (uint8_t j=0;j<_calibTargetN;j++) {
+    const bool hasPrev = (j > 0)                && lapMean[j-1] > 0.0f;
+    const bool hasNext = (j+1 < _calibTargetN)  && lapMean[j+1] > 0.0f;
+    if (hasPrev && hasNext) lapSlope[j] = 0.5f * (lapMean[j+1] - lapMean[j-1]) * invPpr;
+    else if (hasNext)       lapSlope[j] = (lapMean[j+1] - lapMean[j]) * invPpr;
+    else if (hasPrev)       lapSlope[j] = (lapMean[j] - lapMean[j-1]) * invPpr;
+    else                    lapSlope[j] = 0.0f;
+  }
+}
+
 float SectorCalibrator::_trimmedMean(float* vals, uint8_t n) const {
   if (n==0) return 0.0f;
   if (n<=2) {
@@ -315,7 +477,7 @@ bool SectorCalibrator::finishAlignmentIfReady(uint16_t& bestOffsetOut, float& sc
   const bool forward = (_modeDir >= 0);
 
   // Vota entre laps
-  uint16_t* votes = new uint16_t[_cfg.ppr];
+  uint16_t* votes = _votes;
   for (uint16_t k=0;k<_cfg.ppr;k++) votes[k]=0;
 
   float bestGlobalScore = 1e30f;
@@ -336,7 +498,6 @@ bool SectorCalibrator::finishAlignmentIfReady(uint16_t& bestOffsetOut, float& sc
   for (uint16_t k=0;k<_cfg.ppr;k++) {
     if (votes[k] > maxVotes) { maxVotes=votes[k]; finalOff=k; }
   }
-  delete[] votes;
 
   bestOffsetOut = finalOff;
   scoreOut      = bestGlobalScore;
@@ -352,10 +513,48 @@ bool SectorCalibrator::finishAlignmentIfReady(uint16_t& bestOffsetOut, float& sc
   return true;
 }
 
+// ---------------- Dirección por patrón ----------------
+bool SectorCalibrator::inferDirection(const uint32_t* periods, uint16_t n, int8_t& dirOut, float& confOut) const {
+  // Vale cualquiera de los dos patrones: el sentido en que se calibró lo lee con k
+  // ascendente y el opuesto con k descendente, igual que en movimiento real.
+  const float* pat = _patFwdReady ? _patFwd : (_patRevReady ? _patRev : nullptr);
+  if (!pat || n < 4) return false;
+
+  const uint16_t N = _cfg.ppr;
+  float bestAsc = 1e30f, bestDesc = 1e30f;
+  for (uint16_t sh=0; sh<N; ++sh) {
+    float eAsc = 0.0f, eDesc = 0.0f;
+    for (uint16_t i=1; i<n; ++i) {
+      if (periods[i-1] == 0) continue;
+      // Cociente de periodos consecutivos: robusto a cambios lentos de velocidad (coast-down)
+      const float r = (float)periods[i] / (float)periods[i-1];
+
+      const uint16_t a0 = (uint16_t)((sh + i - 1) % N);        // asc: a0 -> a0+1
+      const uint16_t a1 = (uint16_t)((a0 + 1) % N);
+      const uint16_t d0 = (uint16_t)((sh + N - ((i - 1) % N)) % N); // desc: d0 -> d0-1
+      const uint16_t d1 = (uint16_t)((d0 + N - 1) % N);
+
+      float e1 = r - pat[a1] / pat[a0];
+      float e2 = r - pat[d1] / pat[d0];
+      eAsc  += (e1 < 0) ? -e1 : e1;   // L1
+      eDesc += (e2 < 0) ? -e2 : e2;
+      if (eAsc >= bestAsc && eDesc >= bestDesc) break;   // ya no mejora ninguna
+    }
+    if (eAsc  < bestAsc)  bestAsc  = eAsc;
+    if (eDesc < bestDesc) bestDesc = eDesc;
+  }
+
+  const float better = (bestAsc <= bestDesc) ? bestAsc : bestDesc;
+  const float worse  = (bestAsc <= bestDesc) ? bestDesc : bestAsc;
+  dirOut  = (bestAsc <= bestDesc) ? +1 : -1;
+  confOut = (worse > 1e-9f) ? (worse - better) / worse : 0.0f;
+  return true;
+}
+
 // ---------------- Debug ----------------
 void SectorCalibrator::printLUT(Stream& s) const {
-  s.printf("useFWD=%d offFWD=%u | useREV=%d offREV=%u\n",
-           _useFwd?1:0, _offFwd, _useRev?1:0, _offRev);
+  s.printf("useFWD=%d offFWD=%u | useREV=%d offREV=%u | fourierK=%u\n",
+           _useFwd?1:0, _offFwd, _useRev?1:0, _offRev, (unsigned)_fouK);
   s.println("[FWD] s_fwd[k]:");
   for (uint16_t k=0;k<_cfg.ppr;k++) s.printf("sF[%2u]=%.6f\n", k, _lutFwd[k]);
   s.println("[REV] s_rev[k]:");
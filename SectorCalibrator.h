@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include "StaticArena.h"
 
 // ================================================
 // SectorCalibrator (dual-LUT por sentido)
@@ -11,9 +12,13 @@
 // - Construye patrón normalizado (1/s[k]) por sentido
 // - Auto-alineación por sentido: estima y guarda offset
 // - Retro-compatibilidad con una sola LUT en NVS
+// - Modelo compacto opcional: serie de Fourier de K armónicos por sentido
+//   (2K+1 coeficientes en NVS, evaluados a LUT al cargar)
 // ================================================
 class SectorCalibrator {
 public:
+  static const uint8_t kMaxLaps = 16;    // tope de maxLaps (buffers por vuelta en pila)
+
   struct Config {
     const char* nvsNamespace = "encoder"; // distinto por rueda: "encR", "encL", etc.
 
@@ -24,17 +29,24 @@ public:
     const char* nvsKeyLutRev = "lut_rev";
     const char* nvsKeyOffFwd = "off_fwd";
     const char* nvsKeyOffRev = "off_rev";
+    const char* nvsKeyFouFwd = "fou_fwd";
+    const char* nvsKeyFouRev = "fou_rev";
 
     // Claves legacy (single) para migración
     const char* nvsKeyUse    = "use_lut";
     const char* nvsKeyLut    = "lut";
 
     uint16_t    ppr;                     // nº de sectores (pulsos por vuelta)
-    uint8_t     maxLaps = 12;            // límite seguridad
+    uint8_t     maxLaps = 12;            // límite seguridad (se recorta a kMaxLaps)
     bool        useLUTByDefault = true;  // si no hay NVS
+    bool        normalizeLaps   = true;  // normaliza cada vuelta por su media y quita deriva lineal
+    uint8_t     fourierK        = 0;     // 0: LUT completa; >0: s[k] ajustada con K armónicos (K<=(ppr-1)/2)
   };
 
   explicit SectorCalibrator(const Config& cfg);
+
+  // Bytes de StaticArena que consume una instancia con esta Config
+  static size_t arenaBytes(const Config& cfg);
   ~SectorCalibrator();
 
   // Persistencia
@@ -57,6 +69,11 @@ public:
   float  scaleFwd(uint16_t k) const { return _lutFwd[k]; }  // s_fwd[k]
   float  scaleRev(uint16_t k) const { return _lutRev[k]; }  // s_rev[k]
 
+  // Modelo de Fourier: coef = [a0, a1, b1, ..., aK, bK]; K=0 si se usa LUT completa
+  uint8_t fourierK() const { return _fouK; }
+  const float* fourierFwd() const { return _fouFwd; }
+  const float* fourierRev() const { return _fouRev; }
+
   // Corrige periodo por sector y sentido: dt_corr = dt * s_dir[(k+off_dir)%PPR]
   inline float correctDtDir(uint16_t k, float dt_us, int stepDir) const {
     const bool forward = (stepDir >= 0);
@@ -78,6 +95,12 @@ public:
   bool   isAligning() const { return _alignActive; }
   bool   finishAlignmentIfReady(uint16_t& bestOffsetOut, float& scoreOut); // guarda internamente off_fwd/rev
 
+  // ---- Dirección por correlación con el patrón ----
+  // periods: últimos n periodos CRUDOS en orden temporal (antiguo -> reciente).
+  // Compara los cocientes p[i]/p[i-1] con el patrón leído en k ascendente (FWD)
+  // y descendente (REV) en todos los desplazamientos. conf = (peor-mejor)/peor ∈ [0,1].
+  bool   inferDirection(const uint32_t* periods, uint16_t n, int8_t& dirOut, float& confOut) const;
+
   // Debug opcional
   void   printLUT(Stream& s = Serial) const;
   void   printSectorStats(Stream& s = Serial) const; // última calib (del sentido activo)
@@ -87,15 +110,27 @@ public:
 
 private:
   // Helpers
-  void   _alloc();
+  void   _alloc();   // todo desde StaticArena (una vez, en el constructor)
   void   _free();
 
   void   _buildPatternFromLUT_Fwd(); // pattern_fwd[k] = (1/s_fwd[k]) / mean(1/s_fwd)
   void   _buildPatternFromLUT_Rev(); // pattern_rev[k] = (1/s_rev[k]) / mean(1/s_rev)
 
+  // Fourier helpers (ajuste LS = proyección DFT, exacta con muestreo uniforme y K<ppr/2)
+  void   _fitFourier(const float* lut, float* coef) const;
+  void   _evalFourier(const float* coef, uint8_t K, float* lut) const;
+  bool   _loadFourier(const char* key, float* lut, float* scratch);
+
   // Calib helpers (buffers temporales reutilizados para uno u otro sentido)
   void   _resetCalibBuffers();
   float  _trimmedMean(float* vals, uint8_t n) const;
+  void   _lapReference(float* lapMean, float* lapSlope) const; // media y deriva/sector por vuelta
+  // Posición temporal (0..ppr-1) del sector k dentro de su vuelta. La vuelta se
+  // cierra al llegar k=ppr-1: FWD recorre 0..ppr-1; REV recorre ppr-2..0 y luego ppr-1.
+  inline float _lapTimePos(uint16_t k) const {
+    if (_modeDir >= 0 || k == _cfg.ppr - 1) return (float)k;
+    return (float)(_cfg.ppr - 2 - k);
+  }
 
   // Align helpers
   void   _resetAlignBuffers();
@@ -115,6 +150,11 @@ private:
   bool    _patFwdReady = false;
   bool    _patRevReady = false;
 
+  // Modelo de Fourier (solo si fourierK>0)
+  uint8_t _fouK     = 0;
+  float*  _fouFwd   = nullptr; // [2K+1]
+  float*  _fouRev   = nullptr; // [2K+1]
+
   // Offsets por sentido (aplicados solo dentro de correctDtDir)
   uint16_t _offFwd = 0;
   uint16_t _offRev = 0;
@@ -135,6 +175,10 @@ private:
   uint8_t  _alignLap       = 0;
   float*   _alignBuf       = nullptr; // [ppr x maxLaps]
 
+  // Scratch preasignado (finishCalibration / finishAlignment)
+  float*    _sectorMean    = nullptr; // [ppr]
+  uint16_t* _votes         = nullptr; // [ppr]
+
   // Logging
   Stream*  _log = nullptr;
 };
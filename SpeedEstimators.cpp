@@ -0,0 +1,152 @@
+#include "SpeedEstimators.h"
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #define SE_LOGF(fmt, ...) do { if (_log) _log->printf(fmt, ##__VA_ARGS__); } while(0)
+  static inline uint32_t _cycles() { return ESP.getCycleCount(); }
+#else
+  #include <stdio.h>   // host: sin Stream ni contador de ciclos
+  #define SE_LOGF(fmt, ...) do { (void)_log; if (0) printf(fmt, ##__VA_ARGS__); } while(0)
+  static inline uint32_t _cycles() { return 0; }
+#endif
+
+SpeedEstimators::SpeedEstimators(const Config& cfg) : _cfg(cfg) {
+  const int ppr = (_cfg.pulsesPerRev > 1) ? _cfg.pulsesPerRev : 1;
+  _ringLen = (uint16_t)((ppr < (int)kRingMax) ? ppr : (int)kRingMax);
+  _radPerPulse = 6.28318531f / (float)ppr;
+  reset();
+}
+
+int SpeedEstimators::add(Kind kind, float param, const char* name) {
+  if (_n >= kMaxSlots) return -1;
+  _slot[_n].kind  = kind;
+  _slot[_n].param = param;
+  _slot[_n].name  = name ? name : "?";
+  _st[_n] = State();
+  SE_LOGF("[EST] add #%u %s kind=%u param=%.4f\n",
+          (unsigned)_n, _slot[_n].name, (unsigned)kind, (double)param);
+  return _n++;
+}
+
+void SpeedEstimators::reset() {
+  for (uint8_t i=0;i<kMaxSlots;i++) {
+    const float divSum = _st[i].divSum, divMax = _st[i].divMax;
+    const uint32_t cyc = _st[i].cycSum, ns = _st[i].nSamples;
+    _st[i] = State();
+    // conserva estadísticas (se borran con clearStats)
+    _st[i].divSum = divSum; _st[i].divMax = divMax;
+    _st[i].cycSum = cyc;    _st[i].nSamples = ns;
+  }
+  _ringHead = _ringFill = 0;
+  _ringSum = 0.0f;
+  _lastPulseUs = 0;
+}
+
+void SpeedEstimators::clearStats() {
+  for (uint8_t i=0;i<kMaxSlots;i++) {
+    _st[i].divSum = 0.0f; _st[i].divMax = 0.0f;
+    _st[i].cycSum = 0;    _st[i].nSamples = 0;
+  }
+}
+
+void SpeedEstimators::onPulse(float dtCorrUs, uint64_t tUs, float refOmega) {
+  if (dtCorrUs <= 0.0f) return;
+
+  // Anillo de una vuelta (compartido)
+  if (_ringFill >= _ringLen) _ringSum -= _ring[_ringHead];
+  else                       _ringFill++;
+  _ring[_ringHead] = dtCorrUs;
+  _ringSum += dtCorrUs;
+  _ringHead = (uint16_t)((_ringHead + 1) % _ringLen);
+
+  for (uint8_t i=0;i<_n;i++) {
+    const uint32_t c0 = _cycles();
+    _step(i, dtCorrUs, tUs);
+    _st[i].cycSum += _cycles() - c0;
+  }
+  _lastPulseUs = tUs;
+
+  // Divergencia vs referencia
+  const float ref = hasActive() ? _st[_cfg.active].omega : refOmega;
+  for (uint8_t i=0;i<_n;i++) {
+    float d = _st[i].omega - ref;
+    if (d < 0) d = -d;
+    _st[i].divSum += d;
+    if (d > _st[i].divMax) _st[i].divMax = d;
+    _st[i].nSamples++;
+  }
+}
+
+void SpeedEstimators::_step(uint8_t i, float dtCorrUs, uint64_t tUs) {
+  State& st = _st[i];
+  const Slot& sl = _slot[i];
+
+  switch (sl.kind) {
+    case Kind::EMA: {
+      const float a = sl.param;
+      st.perEma = (st.perEma <= 0.0f) ? dtCorrUs : (1.0f - a) * st.perEma + a * dtCorrUs;
+      st.omega  = _radPerPulse * 1.0e6f / st.perEma;
+      break;
+    }
+    case Kind::FullRev: {
+      // _ringLen periodos cubren _ringLen pulsos
+      if (_ringFill >= _ringLen && _ringSum > 0.0f)
+        st.omega = _radPerPulse * (float)_ringLen * 1.0e6f / _ringSum;
+      break;
+    }
+    case Kind::Observer: {
+      // Tracker α-β sobre el ángulo: en cada pulso el ángulo real es exacto.
+      // Marco relativo al pulso anterior: el medido vale _radPerPulse y se rebasa tras cada pulso.
+      const float dt = dtCorrUs * 1.0e-6f;
+      if (!st.obsInit) {
+        st.obsInit = true;                        // arranque: primera muestra
+        st.thErr   = 0.0f;
+        st.omega   = _radPerPulse / dt;
+        break;
+      }
+      const float a = sl.param;
+      const float b = a * a / (2.0f - a);
+      const float thHat = st.thErr + st.omega * dt;   // predicción
+      const float e = _radPerPulse - thHat;            // innovación
+      st.thErr = thHat + a * e - _radPerPulse;         // rebase al nuevo pulso
+      st.omega += b * e / dt;
+      if (st.omega < 0.0f) st.omega = 0.0f;
+      break;
+    }
+    case Kind::MT: {
+      // M/T: desde un flanco hasta el primer flanco tras la ventana mínima
+      if (st.mtStartUs == 0 && st.mtCount == 0) { st.mtStartUs = tUs; break; }
+      st.mtCount++;
+      const uint64_t T = tUs - st.mtStartUs;
+      if ((float)T * 1.0e-6f >= sl.param && T > 0) {
+        st.omega = _radPerPulse * (float)st.mtCount * 1.0e6f / (float)T;
+        st.mtStartUs = tUs;
+        st.mtCount = 0;
+      }
+      break;
+    }
+  }
+}
+
+void SpeedEstimators::onTick(uint64_t nowUs) {
+  if (_lastPulseUs == 0) return;
+  if (nowUs - _lastPulseUs > _cfg.timeoutUs) {
+    SE_LOGF("[EST] timeout -> reset\n");
+    reset();
+  }
+}
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+void SpeedEstimators::printStats(Stream& s) const {
+  s.printf("[EST] active=%d  (ref=%s)\n", (int)_cfg.active,
+           hasActive() ? _slot[_cfg.active].name : "encoder EMA");
+  for (uint8_t i=0;i<_n;i++) {
+    const State& st = _st[i];
+    const float meanDiv = st.nSamples ? st.divSum / (float)st.nSamples : 0.0f;
+    const float cyc     = st.nSamples ? (float)st.cycSum / (float)st.nSamples : 0.0f;
+    s.printf("  #%u %-10s w:%8.3f | |dw| mean:%7.4f max:%7.4f rad/s | %6.0f cyc/pulse | n=%lu%s\n",
+             (unsigned)i, _slot[i].name, (double)st.omega,
+             (double)meanDiv, (double)st.divMax, (double)cyc,
+             (unsigned long)st.nSamples, ((int8_t)i == _cfg.active) ? "  <- control" : "");
+  }
+}
+#endif
@@ -0,0 +1,113 @@
+#ifndef SPEED_ESTIMATORS_H
+#define SPEED_ESTIMATORS_H
+
+#include <stdint.h>
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include <Arduino.h>
+#else
+  class Stream;
+#endif
+#include "Timebase.h"
+
+// ============================================================
+// SpeedEstimators — Banco de estimadores de velocidad en paralelo
+// - Todos se alimentan con el mismo flujo de pulsos de EncoderPCNT
+//   (periodo ya corregido por LUT + timestamp del pulso).
+// - Tipos: EMA(alpha), vuelta completa, observador α-β de ángulo, M/T.
+// - Uno puede mandar el control (active); el resto corre "en sombra".
+// - Estadísticas por estimador: divergencia vs referencia y ciclos de CPU.
+// - Sin heap: ranuras y anillo de tamaño fijo.
+// - También compila en host (sim/SimWheel.h): sin contador de ciclos ni
+//   printStats(); la divergencia sí se mide.
+// ============================================================
+class SpeedEstimators {
+public:
+  static const uint8_t  kMaxSlots = 6;
+  static const uint16_t kRingMax  = 64;   // máx. PPR para el estimador de vuelta completa
+
+  enum class Kind : uint8_t {
+    EMA      = 0,   // param = alpha del periodo (0..1]
+    FullRev  = 1,   // param sin uso: suma de los últimos PPR periodos
+    Observer = 2,   // param = ganancia α del tracker α-β (0..1], β = α²/(2-α)
+    MT       = 3    // param = ventana mínima [s]: M pulsos / T entre flancos
+  };
+
+  struct Slot {
+    Kind        kind  = Kind::EMA;
+    float       param = 1.0f;
+    const char* name  = "ema";
+  };
+
+  struct Config {
+    int      pulsesPerRev = 1;
+    int8_t   active       = -1;    // ranura que manda el control (-1: manda el EMA propio del encoder)
+    uint32_t timeoutUs    = 2000000; // sin pulsos -> todos a 0
+  };
+
+  explicit SpeedEstimators(const Config& cfg);
+
+  // Alta de estimadores (antes de arrancar). Devuelve índice o -1 si no cabe.
+  int  add(Kind kind, float param, const char* name);
+  void setActive(int8_t idx) { _cfg.active = (idx < (int8_t)_n) ? idx : -1; }
+  int8_t active() const { return _cfg.active; }
+
+  // Alimentación (desde EncoderPCNT)
+  //   dtCorrUs: periodo corregido; tUs: timestamp del pulso; refOmega: w del EMA propio del encoder
+  void onPulse(float dtCorrUs, uint64_t tUs, float refOmega);
+  void onTick(uint64_t nowUs);     // timeouts a 0 sin pulsos (tiempos de Timebase)
+  void reset();
+
+  // Lecturas
+  uint8_t count() const { return _n; }
+  float   omega(uint8_t i) const { return (i < _n) ? _st[i].omega : 0.0f; }
+  bool    hasActive() const { return _cfg.active >= 0 && _cfg.active < (int8_t)_n; }
+  float   activeOmega() const { return hasActive() ? _st[_cfg.active].omega : 0.0f; }
+
+  // Estadísticas (divergencia vs referencia = activa o, si no hay, EMA del encoder)
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  void printStats(Stream& s = Serial) const;
+#endif
+  void clearStats();
+
+  void setLog(Stream* s) { _log = s; }
+
+private:
+  struct State {
+    float    omega     = 0.0f;
+    // EMA
+    float    perEma    = 0.0f;
+    // Observer: solo el error de ángulo thHat - thMeas [rad] (acotado, sin
+    // acumular vueltas: un float absoluto perdería resolución con el uso)
+    float    thErr     = 0.0f;
+    bool     obsInit   = false;
+    // M/T
+    uint64_t mtStartUs = 0;
+    uint16_t mtCount   = 0;
+    // Estadísticas
+    float    divSum    = 0.0f;
+    float    divMax    = 0.0f;
+    uint32_t cycSum    = 0;
+    uint32_t nSamples  = 0;
+  };
+
+  void _step(uint8_t i, float dtCorrUs, uint64_t tUs);
+
+  Config   _cfg;
+  Slot     _slot[kMaxSlots];
+  State    _st[kMaxSlots];
+  uint8_t  _n = 0;
+
+  // Anillo compartido de periodos corregidos (para FullRev)
+  float    _ring[kRingMax];
+  uint16_t _ringLen  = 1;
+  uint16_t _ringHead = 0;
+  uint16_t _ringFill = 0;
+  float    _ringSum  = 0.0f;
+
+  uint64_t _lastPulseUs = 0;
+  float    _radPerPulse = 0.0f;
+
+  Stream*  _log = nullptr;
+};
+
+#endif // SPEED_ESTIMATORS_H
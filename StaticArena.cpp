@@ -0,0 +1,84 @@
+#include "StaticArena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include "esp_heap_caps.h"
+  static size_t _heapFree() { return heap_caps_get_free_size(MALLOC_CAP_8BIT); }
+#else
+  static size_t _heapFree() { return 0; }
+#endif
+
+// Inicialización constante: válida aunque otros objetos globales asignen
+// desde sus constructores (orden de inicialización estática indiferente).
+alignas(16) static uint8_t s_arena[STATIC_ARENA_BYTES];
+
+size_t        StaticArena::_used          = 0;
+volatile bool StaticArena::_armed         = false;
+volatile int  StaticArena::_allow         = 0;
+size_t        StaticArena::_heapFreeAtArm = 0;
+
+void* StaticArena::alloc(size_t bytes, size_t align) {
+  if (align == 0) align = 1;
+  const size_t off = (_used + (align - 1)) & ~(align - 1);
+  if (off + bytes > kBytes) {
+    printf("[ARENA] agotada: pide %u B, usados %u/%u B -> aumenta STATIC_ARENA_BYTES\n",
+           (unsigned)bytes, (unsigned)_used, (unsigned)kBytes);
+    abort();
+  }
+  _used = off + bytes;
+  return s_arena + off;
+}
+
+void StaticArena::armHeapGuard() {
+  _heapFreeAtArm = _heapFree();
+  _armed = true;
+}
+
+long StaticArena::heapDeltaBytes() {
+  if (!_armed) return 0;
+  return (long)_heapFreeAtArm - (long)_heapFree();
+}
+
+void StaticArena::_rebase() {
+  if (_armed) _heapFreeAtArm = _heapFree();
+}
+
+void StaticArena::checkHeap(const char* where) {
+#if STATIC_ARENA_HEAP_GUARD
+  if (!_armed || _allow > 0) return;
+  const long d = heapDeltaBytes();
+  if (d > 0) {
+    printf("[ARENA] heap -%ld B tras begin() (malloc/String/lwIP) en %s -> abort\n",
+           d, where ? where : "?");
+    abort();
+  }
+#else
+  (void)where;
+#endif
+}
+
+// ---------- Guardia: reemplazo global de operator new (solo debug) ----------
+#if STATIC_ARENA_HEAP_GUARD
+
+static void* _guardedNew(size_t n) {
+  if (!StaticArena::heapAllowed()) {
+    printf("[ARENA] operator new(%u) tras begin() -> abort\n", (unsigned)n);
+    abort();
+  }
+  void* p = malloc(n ? n : 1);
+  if (!p) abort();
+  return p;
+}
+
+void* operator new(size_t n)   { return _guardedNew(n); }
+void* operator new[](size_t n) { return _guardedNew(n); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept   { return StaticArena::heapAllowed() ? malloc(n ? n : 1) : _guardedNew(n); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return StaticArena::heapAllowed() ? malloc(n ? n : 1) : _guardedNew(n); }
+void  operator delete(void* p) noexcept   { free(p); }
+void  operator delete[](void* p) noexcept { free(p); }
+void  operator delete(void* p, size_t) noexcept   { free(p); }
+void  operator delete[](void* p, size_t) noexcept { free(p); }
+
+#endif
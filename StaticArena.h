@@ -0,0 +1,79 @@
+#ifndef STATIC_ARENA_H
+#define STATIC_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================
+// StaticArena — Memoria de runtime desde un bloque estático
+// - Tamaño fijado en compilación: -DSTATIC_ARENA_BYTES=<n> (por defecto 4 KiB).
+// - Asignación por avance de puntero (bump); no hay free individual:
+//   los objetos se crean una vez en el arranque y viven todo el programa.
+// - Agotarla es un error de configuración: imprime el tamaño pedido y aborta.
+// - Dimensionado (único sitio): STATIC_ARENA_BYTES >= suma de arenaBytes(cfg)
+//   de todo lo que se construya, más ~16 B de alineación por objeto:
+//     SectorCalibrator   1 por rueda   (~1.1 KiB con ppr=8)
+//     OccupancyGrid      si se usa     (~16 KiB con la Config por defecto)
+//     TiledOccupancyMap  si se usa     (~18 KiB con la Config por defecto)
+//   Los 4 KiB por defecto cubren solo las ruedas. DifferentialDrive::begin
+//   imprime used()/capacity() para ajustar el valor con el robot real.
+// - Guardia de heap (debug, -DSTATIC_ARENA_HEAP_GUARD=1): tras armHeapGuard()
+//   (al final de DifferentialDrive::begin) cualquier operator new aborta,
+//   salvo dentro de un HeapAllowScope (p.ej. NVS, que asigna internamente).
+//   operator new no ve malloc (String, lwIP, NVS): checkHeap(), llamado en
+//   cada DifferentialDrive::update, aborta si heapDeltaBytes() > 0 fuera de
+//   un HeapAllowScope. Es global al proceso: otras tareas que asignen (Wi-Fi)
+//   deben arrancar antes de begin() o hacerlo dentro de un HeapAllowScope.
+//   Sin la guardia, heapDeltaBytes() solo mide.
+// ============================================================
+#ifndef STATIC_ARENA_BYTES
+  #define STATIC_ARENA_BYTES 4096
+#endif
+#ifndef STATIC_ARENA_HEAP_GUARD
+  #define STATIC_ARENA_HEAP_GUARD 0
+#endif
+
+class StaticArena {
+public:
+  static const size_t kBytes = STATIC_ARENA_BYTES;
+
+  // Bloque alineado a 'align' (potencia de 2), sin inicializar
+  static void* alloc(size_t bytes, size_t align = 8);
+
+  // Arreglo de T (trivial) inicializado a 'fill'
+  template <class T>
+  static T* allocArray(size_t n, const T& fill = T()) {
+    T* p = static_cast<T*>(alloc(n * sizeof(T), alignof(T)));
+    for (size_t i=0;i<n;i++) p[i] = fill;
+    return p;
+  }
+
+  static size_t used()      { return _used; }
+  static size_t capacity()  { return kBytes; }
+  static size_t remaining() { return kBytes - _used; }
+
+  // --- Guardia de heap ---
+  static void armHeapGuard();
+  static bool heapGuardArmed() { return _armed; }
+  static long heapDeltaBytes();    // heap consumido desde el armado (<0: liberado)
+  static void checkHeap(const char* where);  // aborta si hubo malloc (solo con la guardia)
+
+  // Lo asignado dentro del scope queda aceptado: al cerrar el último se
+  // toma de nuevo la referencia de heap libre.
+  class HeapAllowScope {
+  public:
+    HeapAllowScope()  { _allow++; }
+    ~HeapAllowScope() { if (--_allow == 0) _rebase(); }
+  };
+  static bool heapAllowed() { return !_armed || _allow > 0; }
+
+private:
+  static void _rebase();
+
+  static size_t        _used;
+  static volatile bool _armed;
+  static volatile int  _allow;
+  static size_t        _heapFreeAtArm;
+};
+
+#endif // STATIC_ARENA_H
@@ -0,0 +1,180 @@
+#include "TiledOccupancyMap.h"
+#include <math.h>
+#include <string.h>
+
+// Definiciones fuera de línea: allocArray() las toma por referencia
+const uint16_t TiledOccupancyMap::kUniform;
+const uint16_t TiledOccupancyMap::kNone;
+
+TiledOccupancyMap::TiledOccupancyMap(const Config& cfg)
+: _cfg(cfg) {
+  if (_cfg.width == 0)  _cfg.width = 1;
+  if (_cfg.height == 0) _cfg.height = 1;
+  if (_cfg.resolution <= 0.0f) _cfg.resolution = 0.05f;
+  if (_cfg.poolTiles >= kUniform) _cfg.poolTiles = kUniform - 1;
+  _invRes    = 1.0f / _cfg.resolution;
+  _tilesX    = (uint16_t)((_cfg.width  + (1u << _cfg.tileShift) - 1) >> _cfg.tileShift);
+  _tilesY    = (uint16_t)((_cfg.height + (1u << _cfg.tileShift) - 1) >> _cfg.tileShift);
+  _tileCells = 1u << (2 * _cfg.tileShift);
+
+  // La arena no libera por bloque: la instancia vive todo el programa
+  const uint32_t nTiles = (uint32_t)_tilesX * _tilesY;
+  _dir      = StaticArena::allocArray<uint16_t>(nTiles, kUniform);
+  _owner    = StaticArena::allocArray<uint32_t>(_cfg.poolTiles, 0);
+  _freeNext = StaticArena::allocArray<uint16_t>(_cfg.poolTiles, kNone);
+  _pool     = static_cast<int8_t*>(StaticArena::alloc((size_t)_cfg.poolTiles * _tileCells, 4));
+  _dirty.n    = nTiles;
+  _dirty.bits = StaticArena::allocArray<uint8_t>(_dirty.bytes(), 0);
+  clear();
+  clearDirty();
+}
+
+size_t TiledOccupancyMap::arenaBytes(const Config& cfg) {
+  const uint32_t ts = 1u << cfg.tileShift;
+  const size_t tiles = (size_t)((cfg.width + ts - 1) / ts) * ((cfg.height + ts - 1) / ts);
+  return tiles * sizeof(uint16_t) + (tiles + 7) / 8
+       + (size_t)cfg.poolTiles * (sizeof(uint32_t) + sizeof(uint16_t) + ts * ts) + 16;   // + alineación
+}
+
+void TiledOccupancyMap::clear() {
+  const uint32_t nTiles = (uint32_t)_tilesX * _tilesY;
+  for (uint32_t t=0;t<nTiles;t++) _dir[t] = kUniform;         // desconocido (0)
+  _freeHead = _cfg.poolTiles ? 0 : kNone;
+  for (uint16_t b=0;b<_cfg.poolTiles;b++) _freeNext[b] = (b + 1 < _cfg.poolTiles) ? b + 1 : kNone;
+  _st.tilesUsed = 0;
+  markAllDirty();
+}
+
+// ---------- Pool ----------
+
+bool TiledOccupancyMap::_materialize_(uint32_t t) {
+  if (_freeHead == kNone && !(collapse() && _freeHead != kNone)) return false;
+  const uint16_t b = _freeHead;
+  _freeHead = _freeNext[b];
+  memset(_pool + (size_t)b * _tileCells, (int)(uint8_t)_dir[t], _tileCells);
+  _owner[b] = t;
+  _dir[t] = b;
+  if (++_st.tilesUsed > _st.tilesPeak) _st.tilesPeak = _st.tilesUsed;
+  return true;
+}
+
+bool TiledOccupancyMap::_tryCollapse_(uint32_t t) {
+  const uint16_t e = _dir[t];
+  if (e & kUniform) return false;
+  const int8_t* p = _pool + (size_t)e * _tileCells;
+  if (memcmp(p, p + 1, _tileCells - 1) != 0) return false;   // todas iguales a p[0]
+  _dir[t] = (uint16_t)(kUniform | (uint8_t)p[0]);
+  _freeNext[e] = _freeHead;
+  _freeHead = e;
+  _st.tilesUsed--;
+  _st.collapses++;
+  return true;
+}
+
+uint16_t TiledOccupancyMap::collapse() {
+  uint16_t n = 0;
+  for (uint16_t b=0;b<_cfg.poolTiles;b++) {
+    const uint32_t t = _owner[b];
+    if (_dir[t] == b && _tryCollapse_(t)) n++;   // el bloque sigue asignado a ese tile
+  }
+  return n;
+}
+
+// ---------- Inserción ----------
+
+void TiledOccupancyMap::_update_(int32_t cx, int32_t cy, int8_t dl) {
+  const uint32_t t = _tileOf_(cx, cy);
+  uint16_t e = _dir[t];
+  const int8_t old = (e & kUniform) ? (int8_t)(uint8_t)e
+                                    : _pool[((size_t)e << (2 * _cfg.tileShift)) + _inTile_(cx, cy)];
+  int16_t v = (int16_t)old + dl;
+  if (v < _cfg.lMin) v = _cfg.lMin;
+  if (v > _cfg.lMax) v = _cfg.lMax;
+  if (v == old) return;                       // saturada: ni memoria ni tile sucio
+
+  if (e & kUniform) {
+    if (!_materialize_(t)) { _st.dropped++; return; }
+    e = _dir[t];
+  }
+  _pool[((size_t)e << (2 * _cfg.tileShift)) + _inTile_(cx, cy)] = (int8_t)v;
+  _dirty.set(t);
+}
+
+// Libre en todas las celdas del rayo menos la última, que es eco si hit
+struct TiledOccupancyMap::RayVisit {
+  TiledOccupancyMap* m;
+  bool hit;
+  inline void operator()(int32_t x, int32_t y, bool last) {
+    m->_update_(x, y, (last && hit) ? m->_cfg.lHit : m->_cfg.lMiss);
+  }
+};
+
+void TiledOccupancyMap::insertRange(float x, float y, float th, float bearing, float range) {
+  const bool hit = (range > 0.0f && range < _cfg.maxRange);
+  const float r = hit ? range : _cfg.maxRange;
+  const float a = th + bearing;
+  insertRay(x, y, x + r * cosf(a), y + r * sinf(a), hit);
+}
+
+void TiledOccupancyMap::insertRay(float x0, float y0, float x1, float y1, bool hit) {
+  int32_t cx0, cy0;
+  if (!worldToCell(x0, y0, cx0, cy0)) return;
+  const int32_t cx1 = (int32_t)floorf((x1 - _cfg.originX) * _invRes);
+  const int32_t cy1 = (int32_t)floorf((y1 - _cfg.originY) * _invRes);
+  _st.rays++;
+  RayVisit v = { this, hit };
+  bool clipped;
+  _st.cells += grid::castRay(cx0, cy0, cx1, cy1, _cfg.width, _cfg.height, v, clipped);
+  if (clipped) _st.clipped++;
+}
+
+// ---------- Consultas ----------
+
+bool TiledOccupancyMap::worldToCell(float x, float y, int32_t& cx, int32_t& cy) const {
+  cx = (int32_t)floorf((x - _cfg.originX) * _invRes);
+  cy = (int32_t)floorf((y - _cfg.originY) * _invRes);
+  return (uint32_t)cx < _cfg.width && (uint32_t)cy < _cfg.height;
+}
+
+void TiledOccupancyMap::cellToWorld(int32_t cx, int32_t cy, float& x, float& y) const {
+  x = _cfg.originX + (cx + 0.5f) * _cfg.resolution;
+  y = _cfg.originY + (cy + 0.5f) * _cfg.resolution;
+}
+
+TiledOccupancyMap::State TiledOccupancyMap::state(int32_t cx, int32_t cy) const {
+  const int8_t l = logOdds(cx, cy);
+  if (l >= _cfg.lOcc)  return OccupancyGrid::Occupied;
+  if (l <= _cfg.lFree) return OccupancyGrid::Free;
+  return OccupancyGrid::Unknown;
+}
+
+TiledOccupancyMap::State TiledOccupancyMap::stateAt(float x, float y) const {
+  int32_t cx, cy;
+  return worldToCell(x, y, cx, cy) ? state(cx, cy) : OccupancyGrid::Unknown;
+}
+
+float TiledOccupancyMap::probability(int32_t cx, int32_t cy) const {
+  const float l = logOdds(cx, cy) * (1.0f / 16.0f);
+  return 1.0f / (1.0f + expf(-l));
+}
+
+uint8_t TiledOccupancyMap::obstaclesNear(float x, float y, float radius,
+                                         PotentialField::Obstacle* out, uint8_t max) const {
+  return grid::obstaclesNear(*this, x, y, radius, out, max);
+}
+
+// ---------- Tiles sucios ----------
+
+bool TiledOccupancyMap::tileDirty(uint16_t tx, uint16_t ty) const {
+  return _dirty.test((uint32_t)ty * _tilesX + tx);
+}
+
+bool TiledOccupancyMap::takeDirty(uint32_t& cursor, uint16_t& tx, uint16_t& ty) {
+  uint32_t t;
+  if (!_dirty.take(cursor, t)) return false;
+  // El consumidor va a recorrer el tile: buen momento para devolverlo al pool
+  if (_cfg.autoCollapse) _tryCollapse_(t);
+  tx = (uint16_t)(t % _tilesX);
+  ty = (uint16_t)(t / _tilesX);
+  return true;
+}
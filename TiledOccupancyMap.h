@@ -0,0 +1,121 @@
+#ifndef TILED_OCCUPANCY_MAP_H
+#define TILED_OCCUPANCY_MAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "StaticArena.h"
+#include "PotentialField.h"
+#include "GridOps.h"
+#include "OccupancyGrid.h"
+
+// ============================================================
+// TiledOccupancyMap — Mapa de ocupación disperso para áreas grandes
+// - Misma API y mismas unidades que OccupancyGrid (log-odds int8), para
+//   que planificadores y campos de potencial no distingan uno de otro.
+// - Directorio plano de tiles (uint16 por tile): o bien un valor uniforme
+//   (bit alto + log-odds) o bien el índice de un bloque del pool de tiles
+//   de 2^tileShift x 2^tileShift celdas. Acceso a celda O(1): directorio +
+//   desplazamiento, sin búsquedas.
+// - Un tile uniforme solo se materializa cuando una escritura cambia algún
+//   valor; collapse() devuelve al pool los tiles que vuelven a ser
+//   uniformes (libre saturado, ocupado saturado, desconocido).
+// - Pool agotado: se intenta colapsar; si sigue lleno la actualización se
+//   descarta (stats.dropped). La memoria queda acotada por poolTiles.
+// - Todo desde StaticArena en el constructor (ver arenaBytes()). El pool por
+//   defecto alcanza para un barrido de 360° a maxRange sin descartes
+//   (kSweepTiles); la Config por defecto ocupa ~18 KiB de arena.
+//   Dimensionado de STATIC_ARENA_BYTES: ver StaticArena.h.
+// ============================================================
+class TiledOccupancyMap {
+public:
+  struct Config : OccupancyGrid::Config {
+    // Cota de un barrido de 360° a maxRange=2 m con tiles de 0.8 m: el disco
+    // de 4 m cae en a lo sumo 6x6 tiles (medido en host: pico 32, 0 descartes)
+    static const uint16_t kSweepTiles = 36;
+    uint16_t poolTiles     = kSweepTiles;   // tiles materializables (256 B c/u con tileShift 4; < 32768)
+    bool     autoCollapse  = true;   // colapsa los tiles sucios al pedirlos (takeDirty)
+    Config() { width = 1024; height = 1024; originX = -25.6f; originY = -25.6f; }   // 51 m de lado
+  };
+
+  typedef OccupancyGrid::State State;
+
+  struct Stats {
+    uint32_t rays      = 0;
+    uint32_t cells     = 0;
+    uint32_t clipped   = 0;
+    uint32_t dropped   = 0;      // escrituras perdidas con el pool lleno
+    uint32_t collapses = 0;      // tiles devueltos al pool
+    uint16_t tilesUsed = 0;
+    uint16_t tilesPeak = 0;
+  };
+
+  explicit TiledOccupancyMap(const Config& cfg);
+
+  static size_t arenaBytes(const Config& cfg);
+
+  // --- Inserción ---
+  void insertRange(float x, float y, float th, float bearing, float range);
+  void insertRay(float x0, float y0, float x1, float y1, bool hit);
+  void clear();
+
+  // --- Consultas ---
+  bool    worldToCell(float x, float y, int32_t& cx, int32_t& cy) const;
+  void    cellToWorld(int32_t cx, int32_t cy, float& x, float& y) const;
+  inline int8_t logOdds(int32_t cx, int32_t cy) const {
+    const uint16_t e = _dir[_tileOf_(cx, cy)];
+    if (e & kUniform) return (int8_t)(uint8_t)e;
+    return _pool[((size_t)e << (2 * _cfg.tileShift)) + _inTile_(cx, cy)];
+  }
+  State   state(int32_t cx, int32_t cy) const;
+  State   stateAt(float x, float y) const;
+  float   probability(int32_t cx, int32_t cy) const;
+  uint8_t obstaclesNear(float x, float y, float radius, PotentialField::Obstacle* out, uint8_t max) const;
+
+  // --- Tiles sucios (el tile sucio coincide con el de almacenamiento) ---
+  uint16_t tilesX() const { return _tilesX; }
+  uint16_t tilesY() const { return _tilesY; }
+  uint16_t tileSize() const { return (uint16_t)(1u << _cfg.tileShift); }
+  bool     tileDirty(uint16_t tx, uint16_t ty) const;
+  uint32_t dirtyCount() const { return _dirty.count(); }
+  bool     takeDirty(uint32_t& cursor, uint16_t& tx, uint16_t& ty);
+  void     clearDirty()   { _dirty.clear(); }
+  void     markAllDirty() { _dirty.setAll(); }
+
+  // --- Dispersión ---
+  bool     tileUniform(uint16_t tx, uint16_t ty) const { return _dir[(uint32_t)ty * _tilesX + tx] & kUniform; }
+  uint16_t collapse();                // recorre los tiles materializados
+  uint16_t tilesFree() const { return (uint16_t)(_cfg.poolTiles - _st.tilesUsed); }
+
+  const Config& config() const { return _cfg; }
+  const Stats&  stats()  const { return _st; }
+
+private:
+  static const uint16_t kUniform = 0x8000;
+  static const uint16_t kNone    = 0xFFFF;
+
+  inline uint32_t _tileOf_(int32_t cx, int32_t cy) const {
+    return ((uint32_t)cy >> _cfg.tileShift) * _tilesX + ((uint32_t)cx >> _cfg.tileShift);
+  }
+  inline uint32_t _inTile_(int32_t cx, int32_t cy) const {
+    const uint32_t m = (1u << _cfg.tileShift) - 1u;
+    return (((uint32_t)cy & m) << _cfg.tileShift) | ((uint32_t)cx & m);
+  }
+  void     _update_(int32_t cx, int32_t cy, int8_t dl);
+  bool     _materialize_(uint32_t t);   // uniforme -> bloque del pool
+  bool     _tryCollapse_(uint32_t t);
+  struct RayVisit;
+
+  Config    _cfg;
+  float     _invRes;
+  uint16_t  _tilesX, _tilesY;
+  uint32_t  _tileCells;
+  uint16_t* _dir;         // por tile: kUniform|valor o índice de bloque
+  uint32_t* _owner;       // por bloque: tile que lo usa
+  uint16_t* _freeNext;    // lista de bloques libres
+  uint16_t  _freeHead = kNone;   // kNone = pool lleno
+  int8_t*   _pool;
+  grid::TileBits _dirty;
+  Stats     _st;
+};
+
+#endif // TILED_OCCUPANCY_MAP_H
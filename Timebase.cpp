@@ -0,0 +1,21 @@
+#include "Timebase.h"
+
+#if !defined(ARDUINO) && !defined(ESP_PLATFORM)
+  #include <chrono>
+#endif
+
+volatile bool     Timebase::_virtual = false;
+volatile uint64_t Timebase::_virtUs  = 0;
+
+void Timebase::useVirtual(bool on, uint64_t startUs) {
+  _virtUs  = startUs;
+  _virtual = on;
+}
+
+#if !defined(ARDUINO) && !defined(ESP_PLATFORM)
+uint64_t Timebase::_realUs() {
+  using namespace std::chrono;
+  static const steady_clock::time_point t0 = steady_clock::now();
+  return (uint64_t)duration_cast<microseconds>(steady_clock::now() - t0).count();
+}
+#endif
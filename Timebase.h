@@ -0,0 +1,47 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include <Arduino.h>
+  #include "esp_timer.h"
+#else
+  #ifndef IRAM_ATTR
+    #define IRAM_ATTR
+  #endif
+#endif
+
+// ============================================================
+// Timebase — Reloj monotónico único de 64 bits en microsegundos
+// - ESP32: esp_timer_get_time() (IRAM-safe, no da la vuelta en la práctica).
+// - Host: std::chrono::steady_clock.
+// - Reloj virtual opcional: el tiempo solo avanza con advanceUs()/setUs(),
+//   para simulaciones más rápidas que tiempo real y pruebas deterministas.
+// - nowMs() de 32 bits queda para throttles de debug (restas wrap-safe).
+// ============================================================
+class Timebase {
+public:
+  static inline uint64_t IRAM_ATTR nowUs() {
+    return _virtual ? _virtUs : _realUs();
+  }
+  static inline uint32_t nowMs() { return (uint32_t)(nowUs() / 1000ULL); }
+
+  // Reloj virtual (no usar en ISR mientras se avanza desde otra tarea)
+  static void useVirtual(bool on, uint64_t startUs = 0);
+  static bool isVirtual() { return _virtual; }
+  static void advanceUs(uint64_t dUs) { _virtUs += dUs; }
+  static void setUs(uint64_t tUs)     { _virtUs = tUs; }
+
+private:
+  static uint64_t _realUs();
+
+  static volatile bool     _virtual;
+  static volatile uint64_t _virtUs;
+};
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+inline uint64_t IRAM_ATTR Timebase::_realUs() { return (uint64_t)esp_timer_get_time(); }
+#endif
+
+#endif // TIMEBASE_H
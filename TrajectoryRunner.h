@@ -1,8 +1,14 @@
 #ifndef TRAJECTORY_RUNNER_H
 #define TRAJECTORY_RUNNER_H
 
-#include <Arduino.h>
-#include "DifferentialDrive.h"
+#include <stdint.h>
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include <Arduino.h>
+  #include "DifferentialDrive.h"
+#else
+  class Stream;
+#endif
 
 // ============================================================
 // TrajectoryRunner — Ejecuta trayectorias "giro + avance"
@@ -13,9 +19,44 @@
 //  - planRotateAdvance(dtheta, d, wMax, vMax)  ó planFromPointInRobotFrame(x,y,...)
 //  - run() / update(dt): genera (v,w) por tramos y se los pasa al drive.
 //  - isFinished() indica final de la maniobra.
+//
+// Planificación energética (opcional):
+//  - Modelo por eje: fuerza = inercia·a + Coulomb + viscosa·v, pérdidas
+//    I²R ∝ fuerza² (copperK) + potencia mecánica (con regeneración parcial).
+//  - planRotateAdvanceMinEnergy(): llega en tArrive con mínima energía
+//    (reparte el tiempo entre fases y elige la fracción de aceleración).
+//  - planRotateAdvanceEnergyBudget(): mínimo tiempo con E <= presupuesto.
+//
+// Drive como parámetro de plantilla (solo usa setTwist(v, w) y update(dt)):
+//  - 'TrajectoryRunner' = TrajectoryRunnerT<DifferentialDrive>, compilada
+//    en TrajectoryRunner.cpp.
+//  - En host, TrajectoryRunnerT<SimDrive> (sim/SimDrive.h) incluyendo
+//    TrajectoryRunnerImpl.h: mismo código sobre la planta del simulador.
 // ============================================================
-class TrajectoryRunner {
+template <class Drive>
+class TrajectoryRunnerT {
 public:
+  // Modelo de pérdidas de un eje (lineal: N, m/s; giro: N·m, rad/s)
+  struct EnergyModel {
+    float inertia;   // masa [kg] o inercia [kg·m²] efectiva
+    float coulomb;   // fricción seca [N] o [N·m]
+    float viscous;   // fricción viscosa [N/(m/s)] o [N·m/(rad/s)]
+    float copperK;   // R/kt_eff²: W de cobre por unidad de fuerza² [W/N²] o [W/(N·m)²]
+    float regenEff;  // fracción recuperada de la potencia generada (0 = nada)
+    float accMax;    // [m/s²] o [rad/s²] (0 = sin límite)
+    EnergyModel(float J = 2.0f, float c = 1.0f, float b = 0.5f, float k = 0.5f,
+                float eta = 0.0f, float aMax = 0.0f)
+    : inertia(J), coulomb(c), viscous(b), copperK(k), regenEff(eta), accMax(aMax) {}
+
+    // Potencia eléctrica instantánea [W] con aceleración acc y velocidad vel
+    float power(float acc, float vel) const {
+      const float sg = (vel > 0.0f) ? 1.0f : (vel < 0.0f) ? -1.0f : 0.0f;
+      const float F  = inertia * acc + coulomb * sg + viscous * vel;
+      const float mech = F * vel;
+      return copperK * F * F + ((mech >= 0.0f) ? mech : regenEff * mech);
+    }
+  };
+
   struct Config {
     // Por defecto toma límites del drive al planear si pasas picos=0
     float vMaxDefault = 0.5f;   // [m/s]
@@ -23,9 +64,14 @@ public:
     // Optativo: factor de “suavidad” por si quieres bajar un poco los picos del drive
     float vPeakScale = 1.0f;    // 0<scale<=1
     float wPeakScale = 1.0f;    // 0<scale<=1
+
+    // Planificación energética
+    EnergyModel lin = EnergyModel(2.0f, 1.0f, 0.5f, 0.5f);     // avance
+    EnergyModel rot = EnergyModel(0.05f, 0.2f, 0.05f, 8.0f);   // giro en sitio
+    float alphaMin  = 0.05f;    // fracción mínima de tf en aceleración (y en frenado)
   };
 
-  TrajectoryRunner(const Config& cfg, DifferentialDrive& drive);
+  TrajectoryRunnerT(const Config& cfg, Drive& drive);
 
   // Planificación directa (giro + avance)
   // - dtheta: rad (con signo). Giro en sitio con V=0.
@@ -37,6 +83,21 @@ public:
   // Planificación desde punto en marco del robot {R}: primero orienta, luego avanza.
   void planFromPointInRobotFrame(float x_R, float y_R, float wPeak = 0.0f, float vPeak = 0.0f);
 
+  // Mínima energía llegando en tArrive [s] (giro + avance). Si tArrive no es
+  // alcanzable con los picos/aceleraciones dados, planea el trapezoide y devuelve false.
+  bool planRotateAdvanceMinEnergy(float dtheta, float dist, float tArrive,
+                                  float wPeak = 0.0f, float vPeak = 0.0f);
+
+  // Mínimo tiempo con energía <= eBudgetJ [J]. Si el presupuesto no alcanza
+  // ni con la llegada más lenta explorada, planea esa y devuelve false.
+  bool planRotateAdvanceEnergyBudget(float dtheta, float dist, float eBudgetJ,
+                                     float wPeak = 0.0f, float vPeak = 0.0f);
+
+  // Energía [J] estimada por el modelo: plan vigente / trapezoide equivalente
+  float planEnergy() const;
+  float estimateTrapezoidEnergy(float dtheta, float dist, float wPeak = 0.0f, float vPeak = 0.0f) const;
+  float planDuration() const { return _planRot.tf + _planLin.tf; }
+
   void cancel();             // aborta y pone v=w=0
   void restart();            // reinicia la ejecución del plan actual (t=0 en tramo actual)
 
@@ -55,6 +116,9 @@ public:
   float tInPhase()     const { return _t; }      // tiempo en el tramo actual
   float tfPhase()      const { return _planRot.tf; } // si rotando; si avanzando usa _planLin.tf
 
+  const Config& config() const { return _cfg; }
+  Drive& drive() { return _drive; }
+
   void setLog(Stream* s) { _log = s; }
 
 private:
@@ -70,6 +134,18 @@ private:
   static float evalSymmetricTrapezoid(float t, float t1, float t2, float tf, float qdotPeak);
 
   void _planPhase_(float dq, float peakReq, bool isRotation);
+  void _startPlan_();
+
+  // Energía de un perfil trapezoidal con fracción de aceleración alpha y duración tf
+  static float _phaseEnergy_(const EnergyModel& m, float dq, float alpha, float tf);
+  // Rango de alpha factible para (dq, tf) con pico y aceleración máximos
+  bool  _alphaRange_(const EnergyModel& m, float dq, float tf, float peak, float& lo, float& hi) const;
+  float _bestAlpha_(const EnergyModel& m, float dq, float tf, float peak, float& E) const;
+  float _minTf_(const EnergyModel& m, float dq, float peak) const;
+  // Reparte T entre giro y avance con mínima energía; devuelve E (o kNoPlan)
+  float _bestSplit_(float dqR, float dqL, float T, float wPeak, float vPeak,
+                    float& tR, float& aR, float& aL) const;
+  void _resolvePeaks_(float& wPeak, float& vPeak) const;
   void _beginRotation_();
   void _beginAdvance_();
   void _advanceTime_(float dt);
@@ -86,8 +162,11 @@ private:
     bool  negSign   = false; // signo de dtheta o dist (para w/v)
   };
 
+  static void _setPhase_(PhasePlan& p, float dq, float peakLim, float alpha, float tf);
+  static constexpr float kNoPlan = 1.0e30f;   // energía de un perfil no factible
+
   Config              _cfg;
-  DifferentialDrive&  _drive;
+  Drive&              _drive;
 
   // Plan vigente (dos fases)
   PhasePlan _planRot;   // giro
@@ -102,4 +181,10 @@ private:
   Stream* _log = nullptr;
 };
 
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+// Instanciación por defecto sobre el drive real
+typedef TrajectoryRunnerT<DifferentialDrive> TrajectoryRunner;
+extern template class TrajectoryRunnerT<DifferentialDrive>;
+#endif
+
 #endif // TRAJECTORY_RUNNER_H
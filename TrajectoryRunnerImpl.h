@@ -0,0 +1,432 @@
+#ifndef TRAJECTORY_RUNNER_IMPL_H
+#define TRAJECTORY_RUNNER_IMPL_H
+
+#include "TrajectoryRunner.h"
+#include <math.h>
+
+// ============================================================
+// TrajectoryRunnerImpl — Definiciones de TrajectoryRunnerT<Drive>
+// - Incluir solo donde se instancia otro Drive (p.ej. sim/SimDrive.h);
+//   TrajectoryRunner (DifferentialDrive) ya está compilada en
+//   TrajectoryRunner.cpp.
+// ============================================================
+
+#define TRT_TEMPLATE template <class Drive>
+#define TRT          TrajectoryRunnerT<Drive>
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #define TR_LOGF(fmt, ...) do { if (_log) _log->printf(fmt, ##__VA_ARGS__); } while(0)
+#else
+  #include <stdio.h>   // host: sin Stream; los argumentos se siguen compilando
+  #define TR_LOGF(fmt, ...) do { (void)_log; if (0) printf(fmt, ##__VA_ARGS__); } while(0)
+#endif
+
+TRT_TEMPLATE
+constexpr float TRT::kNoPlan;
+
+TRT_TEMPLATE
+TRT::TrajectoryRunnerT(const Config& cfg, Drive& drive)
+: _cfg(cfg), _drive(drive) {}
+
+// ---------- Planificación pública ----------
+
+TRT_TEMPLATE
+void TRT::planRotateAdvance(float dtheta, float dist, float wPeak, float vPeak) {
+  // Normaliza picos si no los pasaron:
+  _resolvePeaks_(wPeak, vPeak);
+
+  // Fase de giro
+  _planPhase_(dtheta, wPeak, /*isRotation=*/true);
+  // Fase de avance
+  _planPhase_(dist,   vPeak, /*isRotation=*/false);
+
+  _startPlan_();
+}
+
+TRT_TEMPLATE
+bool TRT::planRotateAdvanceMinEnergy(float dtheta, float dist, float tArrive,
+                                     float wPeak, float vPeak) {
+  _resolvePeaks_(wPeak, vPeak);
+  const float dqR = fabsf(dtheta), dqL = fabsf(dist);
+
+  float tR = 0.0f, aR = 0.0f, aL = 0.0f;
+  const float E = _bestSplit_(dqR, dqL, tArrive, wPeak, vPeak, tR, aR, aL);
+  if (E >= kNoPlan) {
+    TR_LOGF("[TR] minE: tArrive=%.3f s no alcanzable -> trapezoide\n", (double)tArrive);
+    planRotateAdvance(dtheta, dist, wPeak, vPeak);
+    return false;
+  }
+
+  _setPhase_(_planRot, dtheta, wPeak, aR, tR);
+  _setPhase_(_planLin, dist,   vPeak, aL, tArrive - tR);
+  TR_LOGF("[TR] minE: T=%.3f s  E=%.2f J (trap %.2f J)  aR=%.3f aL=%.3f\n",
+          (double)tArrive, (double)E,
+          (double)estimateTrapezoidEnergy(dtheta, dist, wPeak, vPeak), (double)aR, (double)aL);
+  _startPlan_();
+  return true;
+}
+
+TRT_TEMPLATE
+bool TRT::planRotateAdvanceEnergyBudget(float dtheta, float dist, float eBudgetJ,
+                                        float wPeak, float vPeak) {
+  _resolvePeaks_(wPeak, vPeak);
+  const float dqR = fabsf(dtheta), dqL = fabsf(dist);
+  float tR = 0.0f, aR = 0.0f, aL = 0.0f;
+
+  // E*(T) decrece con T: bisección sobre la llegada más temprana dentro del presupuesto
+  float tLo = _minTf_(_cfg.rot, dqR, wPeak) + _minTf_(_cfg.lin, dqL, vPeak);
+  if (tLo <= 0.0f) { planRotateAdvance(dtheta, dist, wPeak, vPeak); return true; }
+
+  float tHi = tLo;
+  bool ok = false;
+  for (int k = 0; k < 5 && !ok; k++) {   // explora hasta 32x el tiempo mínimo
+    tHi *= 2.0f;
+    ok = (_bestSplit_(dqR, dqL, tHi, wPeak, vPeak, tR, aR, aL) <= eBudgetJ);
+  }
+  if (ok) {
+    for (int it = 0; it < 24; it++) {
+      const float tMid = 0.5f * (tLo + tHi);
+      if (_bestSplit_(dqR, dqL, tMid, wPeak, vPeak, tR, aR, aL) <= eBudgetJ) tHi = tMid;
+      else                                                                   tLo = tMid;
+    }
+  }
+
+  const float E = _bestSplit_(dqR, dqL, tHi, wPeak, vPeak, tR, aR, aL);
+  _setPhase_(_planRot, dtheta, wPeak, aR, tR);
+  _setPhase_(_planLin, dist,   vPeak, aL, tHi - tR);
+  TR_LOGF("[TR] budget %.2f J: T=%.3f s  E=%.2f J%s\n",
+          (double)eBudgetJ, (double)tHi, (double)E, ok ? "" : "  (fuera de presupuesto)");
+  _startPlan_();
+  return ok;
+}
+
+TRT_TEMPLATE
+float TRT::planEnergy() const {
+  float E = 0.0f;
+  if (_planRot.tf > 0.0f) E += _phaseEnergy_(_cfg.rot, _planRot.dq, _planRot.t1 / _planRot.tf, _planRot.tf);
+  if (_planLin.tf > 0.0f) E += _phaseEnergy_(_cfg.lin, _planLin.dq, _planLin.t1 / _planLin.tf, _planLin.tf);
+  return E;
+}
+
+TRT_TEMPLATE
+float TRT::estimateTrapezoidEnergy(float dtheta, float dist, float wPeak, float vPeak) const {
+  _resolvePeaks_(wPeak, vPeak);
+  PhasePlan r, l;
+  computeSymmetricTrapezoid(fabsf(dtheta), wPeak, r.peakReal, r.t1, r.t2, r.tf);
+  computeSymmetricTrapezoid(fabsf(dist),   vPeak, l.peakReal, l.t1, l.t2, l.tf);
+  float E = 0.0f;
+  if (r.tf > 0.0f) E += _phaseEnergy_(_cfg.rot, fabsf(dtheta), r.t1 / r.tf, r.tf);
+  if (l.tf > 0.0f) E += _phaseEnergy_(_cfg.lin, fabsf(dist),   l.t1 / l.tf, l.tf);
+  return E;
+}
+
+TRT_TEMPLATE
+void TRT::planFromPointInRobotFrame(float x_R, float y_R, float wPeak, float vPeak) {
+  const float dtheta = atan2f(y_R, x_R);           // giro deseado (rad, con signo)
+  const float dist   = hypotf(x_R, y_R);           // avance (m, >=0)
+  planRotateAdvance(dtheta, dist, wPeak, vPeak);
+}
+
+TRT_TEMPLATE
+void TRT::cancel() {
+  _state = Done;
+  _v = 0.0f; _w = 0.0f;
+  _drive.setTwist(0.0f, 0.0f);
+  TR_LOGF("[TR] cancel\n");
+}
+
+TRT_TEMPLATE
+void TRT::restart() {
+  if (_state == Rotating) { _t = 0.0f; _beginRotation_(); }
+  else if (_state == Advancing) { _t = 0.0f; _beginAdvance_(); }
+}
+
+// ---------- Ejecución ----------
+
+TRT_TEMPLATE
+void TRT::update(float dt_s) {
+  if (_state == Done || _state == Idle) {
+    _drive.setTwist(0.0f, 0.0f);
+    _drive.update(dt_s);
+    return;
+  }
+
+  _advanceTime_(dt_s);
+  _applyDrive_();
+  _drive.update(dt_s);
+}
+
+// ---------- Privados: perfiles y fases ----------
+
+TRT_TEMPLATE
+void TRT::computeSymmetricTrapezoid(float dq_abs, float qdotPeakReq,
+                                    float& qdotPeakReal, float& t1, float& t2, float& tf) {
+  // Perfil trapezoidal simétrico (aceleración y frenado con el mismo tiempo t1=tf/3):
+  // Si dq es suficientemente grande, pico = qdotPeakReq y tf = 1.5 * dq_abs / qdotPeakReq.
+  // Si dq es pequeño, se recorta el pico para que t2=t1 (perfil triangular).
+  if (dq_abs <= 0.0f || qdotPeakReq <= 0.0f) {
+    qdotPeakReal = 0.0f; t1 = t2 = tf = 0.0f; return;
+  }
+
+  // Tiempo si logramos alcanzar el pico solicitado (perfil trapezoidal "completo"):
+  float tf_trap = 1.5f * (dq_abs / qdotPeakReq);
+  float t1_trap = tf_trap / 3.0f;
+  float t2_trap = 2.0f * t1_trap;
+
+  // Área bajo qdot(t) con ese perfil es dq_abs. Si eso es válido, adoptamos.
+  // Para perfiles muy cortos, el pico que cumple simetría y área es:
+  //   qdotPeakReal = sqrt( (3/2) * dq_abs / t1 ) con tf = 3*t1
+  // En práctica, detectar si el pico requerido es alcanzable con una aceleración "implícita".
+  // Aquí usamos un criterio práctico: si tf_trap < Tmin -> degradamos a triángulo.
+  // Para no introducir una a_max explícita, siempre aceptamos el trapezoide con ese tf.
+  // Si quieres forzar un triángulo para distancias ultra cortas, puedes introducir un t1_min.
+  qdotPeakReal = qdotPeakReq;
+  t1 = t1_trap; t2 = t2_trap; tf = tf_trap;
+}
+
+TRT_TEMPLATE
+float TRT::evalSymmetricTrapezoid(float t, float t1, float t2, float tf, float qdotPeak) {
+  if (tf <= 0.0f || qdotPeak <= 0.0f) return 0.0f;
+  if (t <= 0.0f) return 0.0f;
+  if (t >= tf)   return 0.0f;
+
+  if (t < t1) {
+    // rampa ascendente
+    return qdotPeak * (t / t1);
+  } else if (t < t2) {
+    // tramo constante
+    return qdotPeak;
+  } else {
+    // rampa descendente
+    const float tr = (tf - t);
+    const float T  = (tf - t2);
+    return qdotPeak * (tr / T);
+  }
+}
+
+TRT_TEMPLATE
+void TRT::_planPhase_(float dq, float peakReq, bool isRotation) {
+  PhasePlan& p = isRotation ? _planRot : _planLin;
+
+  p.negSign = (dq < 0.0f);
+  p.dq      = fabsf(dq);
+  p.peakReq = fabsf(peakReq);
+
+  computeSymmetricTrapezoid(p.dq, p.peakReq, p.peakReal, p.t1, p.t2, p.tf);
+}
+
+TRT_TEMPLATE
+void TRT::_startPlan_() {
+  // Arranque de la primera fase (si dq=0 salta a la siguiente)
+  if (_planRot.dq > 0.0f) _beginRotation_();
+  else if (_planLin.dq > 0.0f) _beginAdvance_();
+  else { _state = Done; _v = 0.0f; _w = 0.0f; }
+
+  TR_LOGF("[TR] plan R: dq=%.4f peak=%.3f tf=%.3f | L: dq=%.4f peak=%.3f tf=%.3f\n",
+          (double)(_planRot.negSign?-_planRot.dq:_planRot.dq), (double)_planRot.peakReal, (double)_planRot.tf,
+          (double)(_planLin.negSign?-_planLin.dq:_planLin.dq), (double)_planLin.peakReal, (double)_planLin.tf);
+}
+
+TRT_TEMPLATE
+void TRT::_resolvePeaks_(float& wPeak, float& vPeak) const {
+  if (wPeak <= 0.0f) wPeak = _cfg.wMaxDefault * _cfg.wPeakScale;
+  if (vPeak <= 0.0f) vPeak = _cfg.vMaxDefault * _cfg.vPeakScale;
+}
+
+// ---------- Privados: modelo de energía ----------
+
+TRT_TEMPLATE
+float TRT::_phaseEnergy_(const EnergyModel& m, float dq, float alpha, float tf) {
+  if (dq <= 0.0f || tf <= 0.0f || alpha <= 0.0f || alpha > 0.5f) return 0.0f;
+
+  const float ta = alpha * tf;              // aceleración = frenado
+  const float tc = tf - 2.0f * ta;          // crucero
+  const float P  = dq / (tf - ta);          // pico (área del trapezoide = dq)
+  const float a  = P / ta;
+
+  // Potencia eléctrica: cobre k·F² + mecánica F·v (generando solo vuelve regenEff)
+  auto pw = [&m](float F, float v) {
+    const float mech = F * v;
+    return m.copperK * F * F + ((mech >= 0.0f) ? mech : m.regenEff * mech);
+  };
+
+  // Con F de signo constante la potencia es cuadrática en t -> Simpson exacto
+  float E = 0.0f;
+
+  // Aceleración: v = a·t, F = J·a + c + b·v  (> 0)
+  {
+    const float v0 = 0.0f, vm = 0.5f * P, v1 = P;
+    const float Fa = m.inertia * a + m.coulomb;
+    E += ta / 6.0f * (pw(Fa + m.viscous*v0, v0) + 4.0f*pw(Fa + m.viscous*vm, vm) + pw(Fa + m.viscous*v1, v1));
+  }
+
+  // Crucero
+  E += tc * pw(m.coulomb + m.viscous * P, P);
+
+  // Frenado: v = P - a·t, F = -J·a + c + b·v (puede cambiar de signo)
+  {
+    const float Fd = -m.inertia * a + m.coulomb;
+    const float F0 = Fd + m.viscous * P, F1 = Fd;
+    float cuts[3] = { 0.0f, ta, ta };
+    int   nSeg = 1;
+    if (F0 * F1 < 0.0f) { cuts[1] = ta * F0 / (F0 - F1); nSeg = 2; }
+    for (int k = 0; k < nSeg; k++) {
+      const float tA = cuts[k], tB = cuts[k + 1], tM = 0.5f * (tA + tB);
+      const float vA = P - a*tA, vM = P - a*tM, vB = P - a*tB;
+      E += (tB - tA) / 6.0f * (pw(Fd + m.viscous*vA, vA) + 4.0f*pw(Fd + m.viscous*vM, vM)
+                               + pw(Fd + m.viscous*vB, vB));
+    }
+  }
+  return E;
+}
+
+TRT_TEMPLATE
+bool TRT::_alphaRange_(const EnergyModel& m, float dq, float tf, float peak,
+                       float& lo, float& hi) const {
+  lo = _cfg.alphaMin;
+  hi = 0.5f;
+  if (tf <= 0.0f) return false;
+  // Pico: dq / (tf·(1-alpha)) <= peak
+  if (peak > 0.0f) hi = fminf(hi, 1.0f - dq / (tf * peak));
+  // Aceleración: dq / (alpha·(1-alpha)·tf²) <= accMax
+  if (m.accMax > 0.0f) {
+    const float g = dq / (m.accMax * tf * tf);
+    if (g > 0.25f) return false;
+    lo = fmaxf(lo, 0.5f * (1.0f - sqrtf(1.0f - 4.0f * g)));
+  }
+  return lo <= hi;
+}
+
+TRT_TEMPLATE
+float TRT::_bestAlpha_(const EnergyModel& m, float dq, float tf, float peak, float& E) const {
+  float lo, hi;
+  if (!_alphaRange_(m, dq, tf, peak, lo, hi)) { E = kNoPlan; return 0.0f; }
+
+  // Sección áurea: E(alpha) unimodal (cobre de aceleración vs pico/fricción viscosa)
+  const float g = 0.618034f;
+  float x1 = hi - g * (hi - lo), x2 = lo + g * (hi - lo);
+  float f1 = _phaseEnergy_(m, dq, x1, tf), f2 = _phaseEnergy_(m, dq, x2, tf);
+  for (int it = 0; it < 20; it++) {
+    if (f1 <= f2) { hi = x2; x2 = x1; f2 = f1; x1 = hi - g * (hi - lo); f1 = _phaseEnergy_(m, dq, x1, tf); }
+    else          { lo = x1; x1 = x2; f1 = f2; x2 = lo + g * (hi - lo); f2 = _phaseEnergy_(m, dq, x2, tf); }
+  }
+  const float a = 0.5f * (lo + hi);
+  E = _phaseEnergy_(m, dq, a, tf);
+  return a;
+}
+
+TRT_TEMPLATE
+float TRT::_minTf_(const EnergyModel& m, float dq, float peak) const {
+  if (dq <= 0.0f) return 0.0f;
+  float lo, hi;
+  // Cotas: pico con alphaMin y triángulo a accMax
+  float tLo = (peak > 0.0f) ? dq / (peak * (1.0f - _cfg.alphaMin)) : 0.0f;
+  if (m.accMax > 0.0f) tLo = fmaxf(tLo, 2.0f * sqrtf(dq / m.accMax));
+  float tHi = (tLo > 0.0f) ? tLo : 1.0f;
+  for (int k = 0; k < 16 && !_alphaRange_(m, dq, tHi, peak, lo, hi); k++) tHi *= 2.0f;
+  for (int it = 0; it < 24; it++) {
+    const float tMid = 0.5f * (tLo + tHi);
+    if (_alphaRange_(m, dq, tMid, peak, lo, hi)) tHi = tMid;
+    else                                         tLo = tMid;
+  }
+  return tHi;
+}
+
+TRT_TEMPLATE
+float TRT::_bestSplit_(float dqR, float dqL, float T, float wPeak, float vPeak,
+                       float& tR, float& aR, float& aL) const {
+  float eR = 0.0f, eL = 0.0f;
+  aR = aL = 0.0f;
+  if (dqR <= 0.0f) { tR = 0.0f; aL = _bestAlpha_(_cfg.lin, dqL, T, vPeak, eL); return eL; }
+  if (dqL <= 0.0f) { tR = T;    aR = _bestAlpha_(_cfg.rot, dqR, T, wPeak, eR); return eR; }
+
+  float lo = _minTf_(_cfg.rot, dqR, wPeak);
+  float hi = T - _minTf_(_cfg.lin, dqL, vPeak);
+  if (lo > hi) { tR = 0.0f; return kNoPlan; }
+
+  // Sección áurea sobre el reparto del tiempo total
+  auto cost = [&](float x) {
+    float e1, e2;
+    _bestAlpha_(_cfg.rot, dqR, x,     wPeak, e1);
+    _bestAlpha_(_cfg.lin, dqL, T - x, vPeak, e2);
+    return e1 + e2;
+  };
+  const float g = 0.618034f;
+  float x1 = hi - g * (hi - lo), x2 = lo + g * (hi - lo);
+  float f1 = cost(x1), f2 = cost(x2);
+  for (int it = 0; it < 20; it++) {
+    if (f1 <= f2) { hi = x2; x2 = x1; f2 = f1; x1 = hi - g * (hi - lo); f1 = cost(x1); }
+    else          { lo = x1; x1 = x2; f1 = f2; x2 = lo + g * (hi - lo); f2 = cost(x2); }
+  }
+  tR = 0.5f * (lo + hi);
+  aR = _bestAlpha_(_cfg.rot, dqR, tR,     wPeak, eR);
+  aL = _bestAlpha_(_cfg.lin, dqL, T - tR, vPeak, eL);
+  return (eR >= kNoPlan || eL >= kNoPlan) ? kNoPlan : eR + eL;
+}
+
+TRT_TEMPLATE
+void TRT::_setPhase_(PhasePlan& p, float dq, float peakLim, float alpha, float tf) {
+  p.negSign = (dq < 0.0f);
+  p.dq      = fabsf(dq);
+  p.peakReq = fabsf(peakLim);
+  if (p.dq <= 0.0f || tf <= 0.0f) { p.peakReal = 0.0f; p.t1 = p.t2 = p.tf = 0.0f; return; }
+  p.tf = tf;
+  p.t1 = alpha * tf;
+  p.t2 = tf - p.t1;
+  p.peakReal = p.dq / (tf - p.t1);
+}
+
+TRT_TEMPLATE
+void TRT::_beginRotation_() {
+  _state = Rotating;
+  _t = 0.0f;
+  TR_LOGF("[TR] begin ROT: dq=%.4f  peak=%.3f  t1=%.3f t2=%.3f tf=%.3f\n",
+          (double)(_planRot.negSign?-_planRot.dq:_planRot.dq),
+          (double)_planRot.peakReal, (double)_planRot.t1, (double)_planRot.t2, (double)_planRot.tf);
+}
+
+TRT_TEMPLATE
+void TRT::_beginAdvance_() {
+  _state = Advancing;
+  _t = 0.0f;
+  TR_LOGF("[TR] begin LIN: dq=%.4f  peak=%.3f  t1=%.3f t2=%.3f tf=%.3f\n",
+          (double)(_planLin.negSign?-_planLin.dq:_planLin.dq),
+          (double)_planLin.peakReal, (double)_planLin.t1, (double)_planLin.t2, (double)_planLin.tf);
+}
+
+TRT_TEMPLATE
+void TRT::_advanceTime_(float dt) {
+  _t += dt;
+
+  if (_state == Rotating) {
+    const float w_mag = evalSymmetricTrapezoid(_t, _planRot.t1, _planRot.t2, _planRot.tf, _planRot.peakReal);
+    _w = _planRot.negSign ? -w_mag : +w_mag;
+    _v = 0.0f;
+
+    if (_t >= _planRot.tf) {
+      // terminar rotación
+      _w = 0.0f;
+      if (_planLin.dq > 0.0f) _beginAdvance_();
+      else { _state = Done; }
+    }
+  }
+  else if (_state == Advancing) {
+    const float v_mag = evalSymmetricTrapezoid(_t, _planLin.t1, _planLin.t2, _planLin.tf, _planLin.peakReal);
+    _v = _planLin.negSign ? -v_mag : +v_mag; // por si algún día quieres dist<0 (retroceso)
+    _w = 0.0f;
+
+    if (_t >= _planLin.tf) {
+      _v = 0.0f; _state = Done;
+    }
+  }
+}
+
+TRT_TEMPLATE
+void TRT::_applyDrive_() {
+  _drive.setTwist(_v, _w);
+}
+
+#undef TR_LOGF
+#undef TRT
+#undef TRT_TEMPLATE
+
+#endif // TRAJECTORY_RUNNER_IMPL_H
@@ -1,32 +1,50 @@
 #ifndef WHEEL_H
 #define WHEEL_H
 
-#include <Arduino.h>
-#include "MotorPWM.h"
-#include "EncoderPCNT.h"
-#include "SectorCalibrator.h"
+#include <math.h>
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include <Arduino.h>
+  #include "MotorPWM.h"
+  #include "EncoderPCNT.h"
+  #include "SectorCalibrator.h"
+#endif
 #include "PIDVel.h"
+#include "SpeedEstimators.h"
+#include "Timebase.h"
+#include "WheelPolicies.h"
 
 // ============================================================
 // Wheel — Rueda diferencial con Motor + Encoder + PID + LUT
 // - Entrada: omega_ref (rad/s, con signo).
 // - PID por magnitud (|u|), signo desde omega_ref.
-// - Alineación/Calibración LUT con asistente (u=±assistU según sentido).
+// - Alineación/Calibración LUT con asistente: velocidad constante en lazo
+//   cerrado (medida por vuelta completa) o u=±assistU en lazo abierto.
 // - Ajusta enc.setStepDirection(+1/-1) según signo aplicado.
 // - Compatibilidad LUT dual (FWD/REV) sin perder alineación por sentido.
+// - Freno activo opcional: si el PID ya está en u=0 y aún sobra velocidad,
+//   pide freno PWM al motor (deceleraciones más rápidas que en coast).
+// - Componentes como políticas de compilación (ver WheelPolicies.h):
+//   WheelT<Motor, Encoder, Calibrator, Controller, Log>. Sin virtuales;
+//   'Wheel' es la instanciación por defecto (compilada en Wheel.cpp).
+//   Para otras composiciones incluir WheelImpl.h.
+// - En host (sin Arduino) compila con políticas de simulación
+//   (sim/SimWheel.h): mismo lazo de control sobre un motor/encoder simulados.
 // ============================================================
-class Wheel {
+template <class Motor, class Encoder, class Calibrator, class Controller, class Log = StreamLog>
+class WheelT {
 public:
   struct Config {
     // Subconfiguraciones
-    MotorPWM::Config         motor;
-    EncoderPCNT::Config      encoder;
-    SectorCalibrator::Config cal;
-    PIDVel::Config           pid;
+    typename Motor::Config      motor;
+    typename Encoder::Config    encoder;
+    typename Calibrator::Config cal;
+    typename Controller::Config pid;
 
-    // Asistente para cal/align (u sostenido)
+    // Asistente para cal/align
     bool  assistOnBoot = true;  // si hay patrón/LUT, permite usar asistente en rutinas
-    float assistU      = 0.50f; // |u| a sostener durante cal/align
+    float assistU      = 0.50f; // |u| inicial (lazo cerrado) o sostenido (lazo abierto)
+    bool  assistClosedLoop = true;  // regula |w| con la velocidad por vuelta (enc.omegaRev)
+    float assistOmega  = 6.0f;  // [rad/s] ref. del asistente si no hay omegaRef externa
 
     // Parámetros de dirección (histeresis cerca de 0)
     float    dirEpsU    = 0.05f;  // umbral de |u_applied| para fijar signo
@@ -35,13 +53,37 @@ public:
     // Alineación automática al boot (si hay LUT/patrón) — se intenta en el sentido actual
     bool    autoAlignOnBoot = true;
     uint8_t alignLapsBoot   = 3;
+
+    // Muestreo asíncrono: a baja velocidad el PID se evalúa solo cuando llega
+    // un pulso nuevo (dt = tiempo real entre muestras); arriba vuelve a periódico.
+    bool  asyncSampling   = false;
+    float asyncOmegaEnter = 3.0f;   // [rad/s] |w_ref| y |w| por debajo -> por pulso
+    float asyncOmegaExit  = 4.0f;   // [rad/s] |w_ref| o |w| por encima -> periódico
+    float asyncMaxDt      = 0.20f;  // [s] sin pulsos en este tiempo -> evalúa con cota de w
+
+    // Freno activo (deceleración controlada): b = brakeKp·(|w| - |w_ref|)
+    bool  activeBrake     = false;
+    float brakeKp         = 0.05f;  // [1/(rad/s)] duty de freno por exceso de velocidad
+    float brakeMax        = 0.60f;  // duty máximo de freno
+    float brakeUEps       = 0.02f;  // |u| del PID por debajo -> el coast ya no basta
+    float brakeOmegaMin   = 0.50f;  // [rad/s] bajo este exceso no se frena
+
+    // Velocidad sin carga a u=1 (para la fcem del decay Auto del motor). 0 = sin hint
+    float omegaNoLoad     = 0.0f;   // [rad/s]
   };
 
-  explicit Wheel(const Config& cfg);
+  explicit WheelT(const Config& cfg);
 
   // Inicializa todo (NVS->LUT, enc->PCNT/ISR, motor->LEDC, etc.)
   void begin();
 
+  // begin() por fases, para solapar arranques (ver DifferentialDrive::begin):
+  //   beginLoad() y beginHardware() son independientes entre sí y entre ruedas;
+  //   beginFinish() va al final (enlaza LUT y lanza auto-align).
+  void beginLoad();       // NVS -> LUT/patrón
+  void beginHardware();   // PCNT/ISR + LEDC
+  void beginFinish();
+
   // --- Control de alto nivel ---
   void  setOmegaRef(float omega_ref_signed);  // rad/s (con signo)
   float omegaRef() const { return _omegaRef; }
@@ -54,10 +96,17 @@ public:
   bool  startCalibration(uint8_t lapsN);
   bool  startAlignment(uint8_t lapsN);
 
+  // Variantes con sentido explícito (+1 FWD, -1 REV), p.ej. para rutinas coordinadas
+  bool  startCalibrationDir(uint8_t lapsN, int dir);
+  bool  startAlignmentDir(uint8_t lapsN, int dir);
+
   // Estado de rutinas (expuestos para coordinación externa)
   bool  isCalibrating() const { return _cal.isCalibrating(); }
   bool  isAligning()   const { return _cal.isAligning(); }
 
+  // Modo de muestreo activo del PID (true = sincronizado a pulsos)
+  bool  asyncActive()  const { return _asyncActive; }
+
   // --- Utilidades LUT (compat dual) ---
   void  setUseLUT(bool on) {
     _cal.setUseLUTFwd(on);
@@ -67,39 +116,52 @@ public:
   bool  useLUT()      const { return _cal.useLUTFwd() || _cal.useLUTRev(); }
   bool  patternReady()const { return _cal.patternFwdReady() || _cal.patternRevReady(); }
   void  clearLUT()          { _cal.clear(); }
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
   void  printLUT(Stream& s = Serial) const { _cal.printLUT(s); }
   void  printSectorStats(Stream& s = Serial) const { _cal.printSectorStats(s); }
+#endif
 
   // --- Estado / lecturas ---
   float omega() const { return _enc.omega(); }  // rad/s (magnitud)
+  float omegaBounded() const { return _enc.omegaBounded(Timebase::nowUs()); }  // acotada si no llegan pulsos
+  uint32_t pulses()    const { return _enc.pulses(); }        // pulsos consumidos (sin signo)
+  float radPerPulse()  const { return _enc.radPerPulse(); }
   float rpm()   const { return _enc.rpm(); }
   float command() const { return _motor.commandApplied(); }     // u firmado aplicado
   float commandMag() const { return fabsf(_motor.commandApplied()); }
   int8_t signApplied() const { return (_motor.commandApplied()>=0.0f)? +1 : -1; }
+  void  setActiveBrake(bool on) { _cfg.activeBrake = on; }
+  float brakeApplied() const { return _motor.braking() ? _motor.brakeCommand() : 0.0f; }
   uint16_t sectorIdx() const { return _enc.sectorIdx(); }
 
+  // Banco de estimadores en sombra (ver SpeedEstimators / EncoderPCNT::attachEstimators)
+  void attachEstimators(SpeedEstimators* est) { _enc.attachEstimators(est); }
+
   // --- Modo neutro / PID ---
   void neutral() { _motor.setCommand(0.0f); }
   void resetPID(float u0 = 0.0f) { _pid.reset(u0); }
 
   // --- Logging ---
   void setLog(Stream* s);
-  void printDebugEvery(uint32_t periodMs = 200);
+  void printDebugEvery(uint32_t periodMs = 200);   // a Log::debugStream() (NullLog: nada)
 
 private:
   void _applyDirectionLogic_();     // decide k++/k-- según u aplicado
   void _assistBegin_(bool isCal, int dir);   // activa asistente con el signo pedido
   void _assistTrackEnd_();          // detecta fin de cal/align y restaura u
+  float _assistCommand_(float dt_s); // u firmado durante cal/align
   void _maybeAutoAlignOnBoot_();    // inicia alineación en boot si procede (en _dir)
+  bool _pidSampleDue_(float dt_s, float& pidDt, float& wMeas); // decide si toca evaluar PID
+  float _brakeCommand_(float uMag, float wRefMag, float wMeasMag) const; // duty de freno
 
 private:
   Config _cfg;
 
   // Componentes
-  MotorPWM          _motor;
-  EncoderPCNT       _enc;
-  SectorCalibrator  _cal;
-  PIDVel            _pid;
+  Motor       _motor;
+  Encoder     _enc;
+  Calibrator  _cal;
+  Controller  _pid;
 
   // Estado de referencia y signo
   float  _omegaRef     = 0.0f;
@@ -110,15 +172,28 @@ private:
   enum AssistMode { AssistNone, AssistCal, AssistAlign };
   AssistMode _assistMode = AssistNone;
   float      _assistPrevU = 0.0f;
+  bool       _assistWasCal   = false;
+  bool       _assistWasAlign = false;
 
   // Dirección (histeresis) y dirección activa de rutina
   int8_t      _dir = +1;             // sentido inferido por mando aplicado
   int8_t      _routineDir = +1;      // sentido “fijado” durante cal/align
   uint32_t    _lastStrongCmdMs = 0;
 
+  // Muestreo asíncrono del PID
+  bool      _asyncActive  = false;
+  uint32_t  _pidSeq       = 0;     // último enc.sampleSeq() usado por el PID
+  uint64_t  _pidLastUs    = 0;     // instante de la última evaluación del PID (Timebase)
+
   // Logging
-  Stream*   _log = nullptr;
+  Log       _log;
   uint32_t  _dbgLastMs = 0;
 };
 
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+// Instanciación por defecto: IBT-4 por LEDC + PCNT + LUT de sectores + PID float
+typedef WheelT<MotorPWM, EncoderPCNT, SectorCalibrator, PIDVel> Wheel;
+extern template class WheelT<MotorPWM, EncoderPCNT, SectorCalibrator, PIDVel>;
+#endif
+
 #endif // WHEEL_H
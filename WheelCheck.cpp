@@ -0,0 +1,12 @@
+#include "WheelImpl.h"
+#include "MotorMCPWM.h"
+#include "PIDVelQ.h"
+
+// ============================================================
+// WheelCheck — Comprobación de compilación de composiciones alternativas
+// - WheelT solo se instancia con las políticas por defecto (Wheel.cpp); aquí
+//   se fuerza la composición más alejada de ella para que un cambio en la
+//   interfaz de una política falle al compilar y no en el sketch de otro.
+// - Sin uso en runtime: --gc-sections descarta el código generado.
+// ============================================================
+template class WheelT<MotorMCPWM, EncoderPCNT, NullCalibrator, PIDVelQ, NullLog>;
@@ -0,0 +1,399 @@
+#ifndef WHEEL_IMPL_H
+#define WHEEL_IMPL_H
+
+#include "Wheel.h"
+
+// ============================================================
+// WheelImpl — Definiciones de WheelT<...>
+// - Incluir solo donde se instancia una composición propia; la
+//   instanciación por defecto (Wheel) ya está compilada en Wheel.cpp.
+// ============================================================
+
+#define WHEELT_TEMPLATE template <class Motor, class Encoder, class Calibrator, class Controller, class Log>
+#define WHEELT          WheelT<Motor, Encoder, Calibrator, Controller, Log>
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #define WHEEL_LOGF(fmt, ...) do { if (_log.enabled()) _log.stream()->printf(fmt, ##__VA_ARGS__); } while(0)
+#else
+  #include <stdio.h>   // host: sin Stream; los argumentos se siguen compilando
+  #define WHEEL_LOGF(fmt, ...) do { (void)_log; if (0) printf(fmt, ##__VA_ARGS__); } while(0)
+#endif
+
+WHEELT_TEMPLATE
+WHEELT::WheelT(const Config& cfg)
+: _cfg(cfg),
+  _motor(_cfg.motor),
+  _enc(_cfg.encoder),
+  _cal(_cfg.cal),
+  _pid(_cfg.pid)
+{}
+
+WHEELT_TEMPLATE
+void WHEELT::begin() {
+  beginLoad();
+  beginHardware();
+  beginFinish();
+}
+
+WHEELT_TEMPLATE
+void WHEELT::beginLoad() {
+  // Calibrador: cargar LUT/patrón (NVS)
+  _cal.load();
+}
+
+WHEELT_TEMPLATE
+void WHEELT::beginHardware() {
+  // Encoder (PCNT/ISR) y motor (LEDC); no dependen de la LUT
+  _enc.begin();
+  _motor.begin();
+}
+
+WHEELT_TEMPLATE
+void WHEELT::beginFinish() {
+  // El encoder corrige con la LUT solo cuando ya está cargada
+  wheel_policy::attachCalibrator(_enc, &_cal);
+
+  // Mensaje inicial
+  WHEEL_LOGF("[Wheel] begin  PPR=%u  useFWD=%d useREV=%d  pattFWD=%d pattREV=%d  assist=%.2f  Ts=%.4f\n",
+             (unsigned)_cfg.encoder.pulsesPerRev,
+             _cal.useLUTFwd()?1:0, _cal.useLUTRev()?1:0,
+             _cal.patternFwdReady()?1:0, _cal.patternRevReady()?1:0,
+             (double)_cfg.assistU, (double)_cfg.pid.Ts);
+
+  // Alineación automática (si procede) en el sentido actual (_dir)
+  _maybeAutoAlignOnBoot_();
+}
+
+WHEELT_TEMPLATE
+void WHEELT::setOmegaRef(float omega_ref_signed) {
+  _omegaRef = omega_ref_signed;
+
+  // Signo de la referencia (con pequeña zona muerta si quieres)
+  _refSign = (_omegaRef >= 0.0f) ? +1 : -1;
+
+  // Si cambió el signo: bumpless reset del PID (magnitud)
+  if (_refSign != _lastRefSign) {
+    _pid.reset(0.0f);
+    _lastRefSign = _refSign;
+    WHEEL_LOGF("[Wheel] ref sign change -> PID.reset()\n");
+  }
+}
+
+WHEELT_TEMPLATE
+void WHEELT::update(float dt_s) {
+  // 1) Encoder y Motor (estado interno)
+  _enc.update(dt_s);
+  _motor.update(dt_s);
+
+  // 2) Si estamos en cal/align -> mantener el sentido fijado en el inicio de la rutina
+  if (_cal.isCalibrating() || _cal.isAligning()) {
+    _enc.setStepDirection(_routineDir);
+  } else {
+    // 3) Lógica de dirección en operación normal
+    _applyDirectionLogic_();
+  }
+
+  // 4) Control de velocidad (PID por magnitud) con el dt real de la muestra
+  //    Periódico (cada tick) o, a baja velocidad, sincronizado a pulsos.
+  //    Durante cal/align manda el asistente (velocidad constante).
+  float u_signed, brake = 0.0f;
+  if (_cfg.assistOnBoot && (_cal.isCalibrating() || _cal.isAligning())) {
+    u_signed = _assistCommand_(dt_s);
+  } else {
+    const float w_ref_mag = fabsf(_omegaRef);
+    float pidDt = dt_s, w_meas_mag = 0.0f;
+    const float u_mag = _pidSampleDue_(dt_s, pidDt, w_meas_mag)
+                      ? _pid.update(w_ref_mag, w_meas_mag, pidDt)  // ∈ [0,1]
+                      : _pid.u();                                  // retiene última salida
+
+    // 5) Aplica signo de la referencia
+    u_signed = (_refSign >= 0 ? +u_mag : -u_mag);
+
+    // 5b) Freno activo si el PID ya no puede quitar más par. Velocidad acotada
+    //     en cada tick: w_meas_mag solo vale si tocaba muestra del PID, y omega()
+    //     se congela sin pulsos (frenaría una rueda ya parada hasta el timeout).
+    if (_cfg.activeBrake)
+      brake = _brakeCommand_(u_mag, w_ref_mag, _enc.omegaBounded(Timebase::nowUs()));
+  }
+  if (_cfg.omegaNoLoad > 0.0f) {
+    // Fcem con signo (sentido de giro inferido) para el decay por cuadrante
+    _motor.setSpeedHint((float)_dir * _enc.omega() / _cfg.omegaNoLoad);
+  }
+  _motor.setBrake(brake);
+  _motor.setCommand(brake > 0.0f ? 0.0f : u_signed);
+
+  // 6) Asistente: detectar fin de cal/align y restaurar u si aplica
+  _assistTrackEnd_();
+}
+
+WHEELT_TEMPLATE
+bool WHEELT::startCalibration(uint8_t lapsN) {
+  // Tomamos el sentido “operativo” actual inferido por la lógica de dirección
+  return startCalibrationDir(lapsN, _dir);
+}
+
+WHEELT_TEMPLATE
+bool WHEELT::startAlignment(uint8_t lapsN) {
+  return startAlignmentDir(lapsN, _dir);
+}
+
+WHEELT_TEMPLATE
+bool WHEELT::startCalibrationDir(uint8_t lapsN, int dir) {
+  if (lapsN == 0 || lapsN > _cfg.cal.maxLaps) return false;
+
+  dir = (dir >= 0) ? +1 : -1;   // +1 FWD, -1 REV
+  _routineDir = dir;
+
+  const bool ok = _cal.startCalibrationDir(lapsN, dir);
+  if (ok) {
+    WHEEL_LOGF("[Wheel] CAL start: %u laps (%s)\n",
+               (unsigned)lapsN, (dir>=0)?"FWD":"REV");
+    _enc.setStepDirection(dir);      // indexado en el sentido deseado
+    if (_cfg.assistOnBoot) _assistBegin_(/*isCal=*/true, dir);
+  }
+  return ok;
+}
+
+WHEELT_TEMPLATE
+bool WHEELT::startAlignmentDir(uint8_t lapsN, int dir) {
+  if (lapsN == 0 || lapsN > _cfg.cal.maxLaps) return false;
+
+  dir = (dir >= 0) ? +1 : -1;   // +1 FWD, -1 REV
+  const bool pattReady = (dir >= 0) ? _cal.patternFwdReady()
+                                    : _cal.patternRevReady();
+  if (!pattReady) return false;
+
+  _routineDir = dir;
+  const bool ok = _cal.startAlignmentDir(lapsN, dir);
+  if (ok) {
+    WHEEL_LOGF("[Wheel] ALIGN start: %u laps (%s)\n",
+               (unsigned)lapsN, (dir>=0)?"FWD":"REV");
+    _enc.setStepDirection(dir);      // indexado en el sentido deseado
+    if (_cfg.assistOnBoot) _assistBegin_(/*isCal=*/false, dir);
+  }
+  return ok;
+}
+
+// -------------------- Helpers privados --------------------
+
+WHEELT_TEMPLATE
+bool WHEELT::_pidSampleDue_(float dt_s, float& pidDt, float& wMeas) {
+  wMeas = _enc.omega();   // magnitud ≥ 0
+  if (!_cfg.asyncSampling) { pidDt = dt_s; return true; }
+
+  // Histéresis de modo: ambos (ref y medida) lentos para entrar, cualquiera rápido para salir
+  const float wRef = fabsf(_omegaRef);
+  const bool wasAsync = _asyncActive;
+  if (_asyncActive) {
+    if (wRef > _cfg.asyncOmegaExit || wMeas > _cfg.asyncOmegaExit) _asyncActive = false;
+  } else {
+    if (wRef < _cfg.asyncOmegaEnter && wMeas < _cfg.asyncOmegaEnter) _asyncActive = true;
+  }
+
+  const uint64_t nowUs = Timebase::nowUs();
+  const uint32_t seq   = _enc.sampleSeq();
+
+  if (!_asyncActive) {
+    if (wasAsync) WHEEL_LOGF("[Wheel] PID sampling -> periodic\n");
+    _pidSeq = seq;
+    _pidLastUs = nowUs;
+    pidDt = dt_s;
+    return true;
+  }
+
+  if (!wasAsync) {
+    // Entrada al modo: la última evaluación fue en este tick
+    _pidSeq = seq;
+    _pidLastUs = nowUs;
+    WHEEL_LOGF("[Wheel] PID sampling -> per-pulse\n");
+    return false;
+  }
+
+  if (seq != _pidSeq) {
+    // Pulso nuevo: dt real entre muestras (timestamp del pulso, no del tick)
+    const uint64_t tUs = _enc.lastSampleUs();
+    const int64_t dUs = (int64_t)(tUs - _pidLastUs);  // <0 si el pulso precede a un fallback
+    _pidSeq = seq;
+    if (dUs <= 0) return false;
+    pidDt = (float)dUs * 1.0e-6f;
+    _pidLastUs = tUs;
+  } else {
+    // Sin pulsos: solo evalúa si llevamos demasiado tiempo parados,
+    // usando la cota superior de w (la estimación retenida está obsoleta).
+    pidDt = (float)(nowUs - _pidLastUs) * 1.0e-6f;
+    if (pidDt < _cfg.asyncMaxDt) return false;
+    wMeas = _enc.omegaBounded(nowUs);
+    _pidLastUs = nowUs;
+  }
+
+  return (pidDt > 0.0f);
+}
+
+WHEELT_TEMPLATE
+float WHEELT::_brakeCommand_(float uMag, float wRefMag, float wMeasMag) const {
+  // Solo cuando el PID está saturado en 0 (coast) y la rueda gira en el
+  // sentido de la referencia (o la ref es 0): al invertir manda el PID.
+  if (uMag > _cfg.brakeUEps) return 0.0f;
+  if (wRefMag > 0.0f && _dir != _refSign) return 0.0f;
+
+  const float excess = wMeasMag - wRefMag;
+  if (excess <= _cfg.brakeOmegaMin) return 0.0f;
+
+  float b = _cfg.brakeKp * excess;
+  if (b > _cfg.brakeMax) b = _cfg.brakeMax;
+  return b;
+}
+
+WHEELT_TEMPLATE
+void WHEELT::_applyDirectionLogic_() {
+  const uint32_t nowMs = Timebase::nowMs();
+
+  // Si el encoder infiere el sentido del patrón con confianza, manda el sensor
+  // (correcto también en coast-down o si empujan el robot)
+  if (_enc.directionLocked()) {
+    const int8_t s = (_enc.stepDirection() >= 0) ? +1 : -1;
+    if (s != _dir) {
+      _dir = s;
+      WHEEL_LOGF("[Wheel] dir (pattern) = %d\n", (int)_dir);
+    }
+    return;
+  }
+
+  // Deriva la dirección del signo del comando APLICADO por el motor,
+  // con pequeña histéresis temporal y de amplitud.
+  const float uA = _motor.commandApplied();
+
+  if (fabsf(uA) > _cfg.dirEpsU) {
+    int8_t s = (uA >= 0.0f) ? +1 : -1;
+    if (s != _dir) {
+      _dir = s;
+      _enc.setStepDirection(_dir);   // informa sentido al encoder
+      WHEEL_LOGF("[Wheel] stepDir = %d\n", (int)_dir);
+    }
+    _lastStrongCmdMs = nowMs;
+  } else {
+    // Si el mando es pequeño, conserva el último signo un rato para evitar flaps.
+    if (nowMs - _lastStrongCmdMs > _cfg.dirHoldMs) {
+      // opcional: podrías forzar +1, preferimos conservarlo
+    }
+  }
+}
+
+WHEELT_TEMPLATE
+void WHEELT::_assistBegin_(bool isCal, int dir) {
+  _assistPrevU = _motor.commandTarget();
+  _assistMode = isCal ? AssistCal : AssistAlign;
+  _enc.setStepDirection(dir);
+
+  if (_cfg.assistClosedLoop) {
+    // Rueda parada (sin ref externa): el PID parte de assistU para no arrancar desde 0
+    if (fabsf(_omegaRef) <= 0.0f) _pid.reset(_cfg.assistU);
+    const float wRef = (fabsf(_omegaRef) > 0.0f) ? fabsf(_omegaRef) : _cfg.assistOmega;
+    WHEEL_LOGF("[Wheel] ASSIST %s: closed-loop |w|=%.2f rad/s (%s)\n",
+               isCal?"CAL":"ALIGN", (double)wRef, (dir>=0)?"FWD":"REV");
+    return;
+  }
+
+  const float uSigned = (dir >= 0) ? +_cfg.assistU : -_cfg.assistU;
+  _motor.setCommand(uSigned);   // sostener en el sentido seleccionado
+
+  WHEEL_LOGF("[Wheel] ASSIST %s: hold u=% .2f (%s)\n",
+             isCal?"CAL":"ALIGN", (double)uSigned, (dir>=0)?"FWD":"REV");
+}
+
+WHEELT_TEMPLATE
+float WHEELT::_assistCommand_(float dt_s) {
+  float u_mag;
+  if (_cfg.assistClosedLoop) {
+    // Realimenta la velocidad por vuelta completa: el error de imanes no entra al lazo
+    const float wRef  = (fabsf(_omegaRef) > 0.0f) ? fabsf(_omegaRef) : _cfg.assistOmega;
+    const float wMeas = _enc.omegaRevValid() ? _enc.omegaRev() : _enc.omega();
+    u_mag = _pid.update(wRef, wMeas, dt_s);
+  } else {
+    u_mag = _cfg.assistU;
+  }
+  // El signo lo fija el sentido de la rutina (el que se está calibrando/alineando)
+  return (_routineDir >= 0) ? +u_mag : -u_mag;
+}
+
+WHEELT_TEMPLATE
+void WHEELT::_assistTrackEnd_() {
+  const bool isCal   = _cal.isCalibrating();
+  const bool isAlign = _cal.isAligning();
+
+  if (_assistMode == AssistCal && _assistWasCal && !isCal) {
+    _motor.setCommand(_assistPrevU);
+    _pid.reset(fabsf(_assistPrevU));   // PID continúa desde el u restaurado
+    _assistMode = AssistNone;
+    WHEEL_LOGF("[Wheel] ASSIST: CAL done -> restore u\n");
+  }
+  if (_assistMode == AssistAlign && _assistWasAlign && !isAlign) {
+    _motor.setCommand(_assistPrevU);
+    _pid.reset(fabsf(_assistPrevU));
+    _assistMode = AssistNone;
+    WHEEL_LOGF("[Wheel] ASSIST: ALIGN done -> restore u\n");
+  }
+  _assistWasCal = isCal; _assistWasAlign = isAlign;
+}
+
+WHEELT_TEMPLATE
+void WHEELT::_maybeAutoAlignOnBoot_() {
+  if (!_cfg.autoAlignOnBoot) return;
+
+  // Intentar auto-align en el sentido operativo actual (_dir)
+  const int dir = _dir; // por defecto +1
+  const bool use = (dir >= 0) ? _cal.useLUTFwd() : _cal.useLUTRev();
+  const bool patt = (dir >= 0) ? _cal.patternFwdReady() : _cal.patternRevReady();
+
+  if (use && patt) {
+    const uint8_t N = _cfg.alignLapsBoot;
+    if (_cal.startAlignmentDir(N, dir)) {
+      WHEEL_LOGF("[Wheel] ALIGN auto: %u laps (%s)\n", (unsigned)N, (dir>=0)?"FWD":"REV");
+      _routineDir = dir;
+      _enc.setStepDirection(dir);
+      if (_cfg.assistOnBoot) _assistBegin_(/*isCal=*/false, dir);
+    }
+  }
+}
+
+// -------------------- Logging --------------------
+
+WHEELT_TEMPLATE
+void WHEELT::setLog(Stream* s) {
+  _log.set(s);
+  // Propaga si quieres logs también en componentes:
+  //_enc.setLog(s);
+  //_motor.setLog(s);
+  //_pid.setLog(s);
+}
+
+WHEELT_TEMPLATE
+void WHEELT::printDebugEvery(uint32_t periodMs) {
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  Stream* out = _log.debugStream();
+  if (!out) return;
+  const uint32_t now = Timebase::nowMs();
+  if (now - _dbgLastMs < periodMs) return;
+  _dbgLastMs = now;
+
+  const float uT = _motor.commandTarget();
+  const float uA = _motor.commandApplied();
+  const int   dir = (_enc.stepDirection() >= 0)? +1 : -1;
+
+  out->printf("[Wheel] wRef:%7.3f rad/s | w:%7.3f | uT:% .3f uA:% .3f brk:%.2f | dir:%+d | sector:%2u | use(F,R)=(%d,%d) %s%s\n",
+    (double)_omegaRef, (double)_enc.omega(),
+    (double)uT, (double)uA, (double)brakeApplied(),
+    dir,
+    (unsigned)_enc.sectorIdx(),
+    _cal.useLUTFwd()?1:0, _cal.useLUTRev()?1:0,
+    _cal.isCalibrating() ? "[CAL] " : "",
+    _cal.isAligning()    ? "[ALIGN]" : "");
+#else
+  (void)periodMs;   // host: sin Stream
+#endif
+}
+
+#undef WHEEL_LOGF
+#undef WHEELT
+#undef WHEELT_TEMPLATE
+
+#endif // WHEEL_IMPL_H
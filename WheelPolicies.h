@@ -0,0 +1,85 @@
+#ifndef WHEEL_POLICIES_H
+#define WHEEL_POLICIES_H
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include <Arduino.h>
+#else
+  class Stream;   // host: sin Arduino (ver sim/SimWheel.h)
+#endif
+
+// ============================================================
+// WheelPolicies — Políticas de compilación para WheelT<...>
+// - Log: StreamLog (Stream* en runtime, como siempre) o NullLog (todas las
+//   ramas de log desaparecen en compilación).
+// - NullCalibrator: rueda sin LUT ni rutinas de cal/align.
+// - attachCalibrator(): enlaza encoder y calibrador solo si el tipo lo admite.
+//
+// Interfaz mínima que WheelT espera de cada componente:
+//   Log:        set(s); enabled(); stream(); debugStream() (destino de
+//               printDebugEvery: nullptr => no imprime)
+//   Motor:      Config; begin(); update(dt); setCommand(u); commandTarget();
+//               commandApplied(); setBrake(b); braking(); brakeCommand();
+//               setSpeedHint(e)
+//   Encoder:    Config; begin(); update(dt); omega(); rpm(); sectorIdx();
+//               stepDirection(); setStepDirection(d); directionLocked();
+//               sampleSeq(); lastSampleUs(); omegaBounded(t); omegaRevValid();
+//               omegaRev(); pulses(); radPerPulse(); attachEstimators(p)
+//   Calibrator: Config{maxLaps}; load(); save(); clear(); isCalibrating();
+//               isAligning(); useLUTFwd/Rev(); setUseLUTFwd/Rev(); patternFwd/RevReady();
+//               startCalibrationDir(n,d); startAlignmentDir(n,d); printLUT(s); printSectorStats(s)
+//   Controller: Config{Ts}; reset(u0); update(r, y, dt); u()
+// ============================================================
+
+// ---------- Log ----------
+struct StreamLog {
+  Stream* s = nullptr;
+  inline void    set(Stream* st)   { s = st; }
+  inline bool    enabled() const   { return s != nullptr; }
+  inline Stream* stream()  const   { return s; }
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  inline Stream* debugStream() const { return s ? s : &Serial; }   // sin log -> Serial
+#else
+  inline Stream* debugStream() const { return s; }
+#endif
+};
+
+struct NullLog {
+  inline void set(Stream*) {}
+  static constexpr bool enabled()  { return false; }
+  static inline Stream* stream()   { return nullptr; }
+  static inline Stream* debugStream() { return nullptr; }
+};
+
+// ---------- Calibrador nulo ----------
+class NullCalibrator {
+public:
+  struct Config {
+    uint8_t maxLaps = 0;
+  };
+  explicit NullCalibrator(const Config&) {}
+
+  inline void load() {}
+  inline void save() {}
+  inline void clear() {}
+  inline bool isCalibrating() const { return false; }
+  inline bool isAligning()    const { return false; }
+  inline bool useLUTFwd()     const { return false; }
+  inline bool useLUTRev()     const { return false; }
+  inline void setUseLUTFwd(bool) {}
+  inline void setUseLUTRev(bool) {}
+  inline bool patternFwdReady() const { return false; }
+  inline bool patternRevReady() const { return false; }
+  inline bool startCalibrationDir(uint8_t, int) { return false; }
+  inline bool startAlignmentDir(uint8_t, int)   { return false; }
+  inline void printLUT(Stream&) const {}
+  inline void printSectorStats(Stream&) const {}
+};
+
+namespace wheel_policy {
+  template <class Enc, class Cal>
+  inline void attachCalibrator(Enc& e, Cal* c) { e.attachCalibrator(c); }
+  template <class Enc>
+  inline void attachCalibrator(Enc&, NullCalibrator*) {}
+}
+
+#endif // WHEEL_POLICIES_H
@@ -0,0 +1,77 @@
+#ifndef DIFF_PLANT_H
+#define DIFF_PLANT_H
+
+#include <math.h>
+#include "../Kinematics.h"
+#include "../Ramp.h"
+
+// ============================================================
+// DiffPlant — Planta cinemática de un robot diferencial (solo host)
+// - Twist de referencia -> rampas/límites de DifferentialDrive (Ramp.h)
+//   -> kin::Diff2 con tope de omega de rueda -> integración por punto
+//   medio (la misma que la odometría).
+// - Sin PID/PWM/encoders: la pose integrada es a la vez verdad y odometría.
+// - Sin estado propio: step() lee un State y escribe el siguiente, para
+//   que SwarmSim pueda pasar de un búfer a otro sin copias extra.
+// ============================================================
+class DiffPlant {
+public:
+  // Mismos campos/criterios que DifferentialDrive::Config
+  struct Config {
+    float wheelRadius   = 0.05f;   // [m]
+    float trackWidth    = 0.20f;   // [m]
+    float vMax          = 0.8f;    // [m/s]
+    float wMax          = 6.0f;    // [rad/s]
+    float vAccMax       = 1.5f;    // [m/s^2]  (0 => sin rampa)
+    float wAccMax       = 10.0f;   // [rad/s^2]
+    float vDecMax       = 0.0f;    // [m/s^2]   (0 => igual que la aceleración)
+    float wDecMax       = 0.0f;    // [rad/s^2]
+    float omegaWheelMax = 120.0f;  // [rad/s]  (<=0 => desactivado)
+  };
+
+  struct State {
+    float x = 0.0f, y = 0.0f, th = 0.0f;   // pose
+    float v = 0.0f, w = 0.0f;              // twist tras rampas y saturación
+    float path = 0.0f;                     // [m]
+  };
+
+  explicit DiffPlant(const Config& cfg) : _cfg(cfg), _kin(cfg.wheelRadius, cfg.trackWidth) {}
+
+  // 'out' puede ser el mismo objeto que 'in'
+  void step(const State& in, State& out, float vRef, float wRef, float dt) const {
+    const State r = in;
+    float v = ramp::axis(vRef, r.v, _cfg.vAccMax, _cfg.vDecMax, dt);
+    float w = ramp::axis(wRef, r.w, _cfg.wAccMax, _cfg.wDecMax, dt);
+    v = (v < -_cfg.vMax) ? -_cfg.vMax : (v > _cfg.vMax) ? _cfg.vMax : v;
+    w = (w < -_cfg.wMax) ? -_cfg.wMax : (w > _cfg.wMax) ? _cfg.wMax : w;
+
+    float om[kin::Diff2::kWheels];
+    _kin.inverse(v, 0.0f, w, om);
+    if (_cfg.omegaWheelMax > 0.0f) {
+      const float aMax = fmaxf(fabsf(om[0]), fabsf(om[1]));
+      if (aMax > _cfg.omegaWheelMax) {
+        const float s = _cfg.omegaWheelMax / aMax;
+        v *= s; w *= s; om[0] *= s; om[1] *= s;
+      }
+    }
+
+    // La planta sigue a las ruedas; integración por punto medio
+    float vx, vy, wz;
+    _kin.forward(om, vx, vy, wz);
+    const float thM = r.th + 0.5f * wz * dt;
+    out.x    = r.x + vx * dt * cosf(thM);
+    out.y    = r.y + vx * dt * sinf(thM);
+    out.th   = r.th + wz * dt;
+    out.v    = v;
+    out.w    = w;
+    out.path = r.path + fabsf(vx) * dt;
+  }
+
+  const Config& config() const { return _cfg; }
+
+private:
+  Config     _cfg;
+  kin::Diff2 _kin;
+};
+
+#endif // DIFF_PLANT_H
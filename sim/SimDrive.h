@@ -0,0 +1,42 @@
+#ifndef SIM_DRIVE_H
+#define SIM_DRIVE_H
+
+#include "DiffPlant.h"
+
+// ============================================================
+// SimDrive — Sustituto host de DifferentialDrive sobre DiffPlant
+// - Expone lo que usan TrajectoryRunnerT y MissionBenchT: setTwist(),
+//   update(dt), resetOdometry() y las lecturas odom*/vMeas/wMeas.
+// - Odometría = pose de la planta (encoders ideales): las corridas son
+//   deterministas y miden solo planificador + rampas + cinemática.
+// ============================================================
+class SimDrive {
+public:
+  typedef DiffPlant::Config Config;
+
+  explicit SimDrive(const Config& cfg) : _plant(cfg) {}
+
+  void setTwist(float v_mps, float w_radps) { _vRef = v_mps; _wRef = w_radps; }
+  void update(float dt_s) { if (dt_s > 0.0f) _plant.step(_s, _s, _vRef, _wRef, dt_s); }
+
+  void resetOdometry(float x = 0.0f, float y = 0.0f, float theta = 0.0f) {
+    _s.x = x; _s.y = y; _s.th = theta;
+    _s.path = 0.0f;
+  }
+  float odomX()     const { return _s.x; }
+  float odomY()     const { return _s.y; }
+  float odomTheta() const { return _s.th; }
+  float odomPath()  const { return _s.path; }
+  float vMeas()     const { return _s.v; }
+  float wMeas()     const { return _s.w; }
+
+  const DiffPlant::State& state() const { return _s; }
+  const Config& config() const { return _plant.config(); }
+
+private:
+  DiffPlant        _plant;
+  DiffPlant::State _s;
+  float            _vRef = 0.0f, _wRef = 0.0f;
+};
+
+#endif // SIM_DRIVE_H
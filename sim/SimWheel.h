@@ -0,0 +1,258 @@
+#ifndef SIM_WHEEL_H
+#define SIM_WHEEL_H
+
+#include <math.h>
+#include <stdint.h>
+#include "../WheelImpl.h"
+#include "../SpeedEstimators.h"
+#include "../Timebase.h"
+
+// ============================================================
+// SimWheel — Políticas host de WheelT<...> (motor y encoder simulados)
+// - SimShaft: eje motor+rueda de primer orden. Con mando u != 0:
+//   tau·dw/dt = omegaNoLoad·u - w; en coast solo rozamiento (tauCoast) y
+//   con freno PWM b se suma b·w/tau. Rozamiento seco en todos los casos.
+// - Imanes con error de colocación opcional (magnetErr): pulsos de un canal
+//   en cada cruce, en ambos sentidos, con timestamp interpolado dentro del
+//   sub-paso (equivale a la captura HW, sin latencia de ISR).
+// - SimMotor: misma interfaz de mando que MotorPWM/MotorMCPWM (slew, freno).
+// - SimEncoder: misma parte SW que EncoderPCNT::update (EMA de periodo,
+//   anillo de una vuelta, sampleSeq/lastSampleUs, omegaBounded, sectores,
+//   SpeedEstimators con ranura activa), alimentada desde el SimShaft.
+// - Tiempos en Timebase: usar el reloj virtual (ver SimWheelDrive).
+// ============================================================
+class SimShaft {
+public:
+  static const uint8_t kMaxMagnets = 64;
+
+  struct Config {
+    float omegaNoLoad = 30.0f;    // [rad/s] con u=1
+    float tau         = 0.08f;    // [s] constante de tiempo con mando
+    float tauCoast    = 0.60f;    // [s] decaimiento en coast (rozamiento viscoso)
+    float dryDecel    = 4.0f;     // [rad/s^2] rozamiento seco
+    int   pulsesPerRev = 8;       // imanes
+    float magnetErr   = 0.0f;     // error de colocación máx. [fracción del paso]
+    float subStep     = 0.0005f;  // [s] integración interna
+  };
+
+  explicit SimShaft(const Config& cfg) : _cfg(cfg) {
+    if (_cfg.pulsesPerRev < 1) _cfg.pulsesPerRev = 1;
+    if (_cfg.pulsesPerRev > kMaxMagnets) _cfg.pulsesPerRev = kMaxMagnets;
+    // Patrón determinista (misma rueda en cada corrida); el imán 0 es la referencia
+    for (int k=0;k<_cfg.pulsesPerRev;k++) _mag[k] = _cfg.magnetErr * sinf(2.39996323f * (float)k);
+  }
+
+  // Avanza dt con el mando aplicado (u firmado, freno b en [0,1]) desde t0Us
+  void step(float u, float brake, float dt, uint64_t t0Us) {
+    int n = (int)ceilf(dt / _cfg.subStep);
+    if (n < 1) n = 1;
+    const float h = dt / (float)n;
+    for (int i=0;i<n;i++) {
+      float a;
+      if (u != 0.0f) a = (_cfg.omegaNoLoad * u - _w) / _cfg.tau;
+      else           a = -_w / _cfg.tauCoast - brake * _w / _cfg.tau;
+      float w = _w + a * h;
+      // Rozamiento seco: frena hacia 0 sin cruzarlo
+      const float dec = _cfg.dryDecel * h;
+      if (w > dec) w -= dec; else if (w < -dec) w += dec; else w = 0.0f;
+
+      const float th0 = _th;
+      _th += 0.5f * (_w + w) * h;
+      _w = w;
+      _emitPulses_(th0, _th, (double)t0Us + 1.0e6 * (double)h * (double)i, 1.0e6 * (double)h);
+    }
+  }
+
+  float omega() const { return _w; }     // [rad/s] firmado
+  float angle() const { return _th; }    // [rad] acumulado
+
+  // Instantánea estilo ISR (contador, timestamp del último pulso, último periodo)
+  uint32_t count()    const { return _count; }
+  uint64_t lastUs()   const { return _lastUs; }
+  uint32_t periodUs() const { return _periodUs; }
+
+  const Config& config() const { return _cfg; }
+
+private:
+  // Ángulo del imán c (c sin acotar: vuelta = c div PPR)
+  float _edge_(int32_t c) const {
+    const int n = _cfg.pulsesPerRev;
+    int32_t turn = c / n, k = c % n;
+    if (k < 0) { k += n; turn--; }
+    return 6.28318531f * ((float)turn + ((float)k + _mag[k]) / (float)n);
+  }
+
+  void _emitPulses_(float th0, float th1, double tUs, double hUs) {
+    while (th1 >= _edge_(_cell + 1)) { _cell++; _pulse_(_cross_(th0, th1, _edge_(_cell), tUs, hUs)); }
+    while (th1 <  _edge_(_cell))     { _pulse_(_cross_(th0, th1, _edge_(_cell), tUs, hUs)); _cell--; }
+  }
+  static uint64_t _cross_(float th0, float th1, float e, double tUs, double hUs) {
+    const float d = th1 - th0;
+    const double f = (fabsf(d) > 1e-9f) ? (double)((e - th0) / d) : 1.0;
+    return (uint64_t)(tUs + ((f < 0.0) ? 0.0 : (f > 1.0) ? 1.0 : f) * hUs);
+  }
+  void _pulse_(uint64_t tUs) {
+    const uint64_t p = (_lastUs == 0) ? 0 : (tUs - _lastUs);
+    if (p) _periodUs = (p > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)p;
+    _lastUs = tUs;
+    _count++;
+  }
+
+  Config   _cfg;
+  float    _mag[kMaxMagnets];
+  float    _w = 0.0f, _th = 0.0f;
+  int32_t  _cell = 0;            // imán por debajo del ángulo actual
+  uint32_t _count = 0;
+  uint64_t _lastUs = 0;
+  uint32_t _periodUs = 0;
+};
+
+// ---------- Motor ----------
+class SimMotor {
+public:
+  struct Config {
+    bool  invert         = false;
+    float slewRatePerSec = 0.0f;
+  };
+  explicit SimMotor(const Config& cfg) : _cfg(cfg) {}
+
+  void begin() { _uTarget = _uApplied = 0.0f; }
+  void update(float dt_s) {
+    if (_cfg.slewRatePerSec > 0.0f && dt_s > 0.0f) {
+      const float maxStep = _cfg.slewRatePerSec * dt_s;
+      const float err = _uTarget - _uApplied;
+      if (err >  maxStep) _uApplied += maxStep;
+      else if (err < -maxStep) _uApplied -= maxStep;
+      else _uApplied = _uTarget;
+    } else {
+      _uApplied = _uTarget;
+    }
+    _braking = (_uApplied == 0.0f && _brake > 0.0f);
+  }
+
+  void  setCommand(float uSigned) {
+    if (_cfg.invert) uSigned = -uSigned;
+    _uTarget = (uSigned < -1.0f) ? -1.0f : (uSigned > 1.0f) ? 1.0f : uSigned;
+  }
+  float commandTarget()  const { return _uTarget; }
+  float commandApplied() const { return _uApplied; }
+  void  setBrake(float b) { _brake = (b < 0.0f) ? 0.0f : (b > 1.0f) ? 1.0f : b; }
+  float brakeCommand() const { return _brake; }
+  bool  braking() const { return _braking; }
+  void  setSpeedHint(float) {}
+
+private:
+  Config _cfg;
+  float  _uTarget = 0.0f, _uApplied = 0.0f, _brake = 0.0f;
+  bool   _braking = false;
+};
+
+// ---------- Encoder ----------
+class SimEncoder {
+public:
+  static const uint16_t kRevRingMax = 64;
+
+  struct Config {
+    const SimShaft* shaft = nullptr;   // obligatorio
+    int      pulsesPerRev  = 8;        // = shaft->config().pulsesPerRev
+    float    alphaPeriod   = 1.0f;     // mismos criterios que EncoderPCNT::Config
+    uint32_t timeoutStopMs = 2000;
+  };
+  explicit SimEncoder(const Config& cfg)
+  : _cfg(cfg), _ppr((cfg.pulsesPerRev > 1) ? cfg.pulsesPerRev : 1) {
+    _revLen = (uint16_t)((_ppr < (int)kRevRingMax) ? _ppr : (int)kRevRingMax);
+  }
+
+  void begin() {
+    _lastConsumed = _cfg.shaft->count();
+    _lastSeenUs   = Timebase::nowUs();
+    _periodEmaUs  = 0.0f;
+    _omega = 0.0f;
+  }
+
+  void update(float) {
+    const uint32_t cnt = _cfg.shaft->count();
+    const uint32_t per = _cfg.shaft->periodUs();
+    const uint64_t last = _cfg.shaft->lastUs();
+    const uint64_t nowUs = Timebase::nowUs();
+    if (_est) _est->onTick(nowUs);
+
+    if (cnt == _lastConsumed) {
+      if (nowUs - _lastSeenUs > (uint64_t)_cfg.timeoutStopMs * 1000ULL) {
+        _omega = 0.0f; _periodEmaUs = 0.0f;
+        _revFill = _revHead = 0; _revSumUs = 0;
+      }
+      return;
+    }
+    const uint32_t delta = cnt - _lastConsumed;
+    _lastConsumed = cnt;
+    _pulseTsUs = last;
+    for (uint32_t i=0;i<delta;i++) {
+      if (per == 0) continue;
+      _applyPeriod_(per);
+    }
+    if (per != 0) { _lastSampleUs = last; _sampleSeq++; }
+  }
+
+  float omega() const { return _omega; }
+  float rpm()   const { return _omega * (60.0f / 6.28318531f); }
+  uint32_t pulses()      const { return _lastConsumed; }
+  float    radPerPulse() const { return 6.28318531f / (float)_ppr; }
+  uint32_t sampleSeq()    const { return _sampleSeq; }
+  uint64_t lastSampleUs() const { return _lastSampleUs; }
+  float omegaBounded(uint64_t nowUs) const {
+    if (_lastSampleUs == 0 || nowUs <= _lastSampleUs) return _omega;
+    const float bound = 6.28318531f * 1.0e6f / ((float)_ppr * (float)(nowUs - _lastSampleUs));
+    return (bound < _omega) ? bound : _omega;
+  }
+  bool  omegaRevValid() const { return _revFill >= _revLen; }
+  float omegaRev() const {
+    if (!omegaRevValid() || _revSumUs == 0) return 0.0f;
+    return 6.28318531f * 1.0e6f * (float)_revLen / ((float)_ppr * (float)_revSumUs);
+  }
+  uint16_t sectorIdx() const { return _sectorIdx; }
+  void  setStepDirection(int dir) { _stepDir = (dir >= 0) ? +1 : -1; }
+  int   stepDirection() const { return _stepDir; }
+  bool  directionLocked() const { return false; }
+  void  attachEstimators(SpeedEstimators* est) { _est = est; }
+
+private:
+  void _applyPeriod_(uint32_t dtUs) {
+    if (_revFill >= _revLen) _revSumUs -= _revBuf[_revHead]; else _revFill++;
+    _revBuf[_revHead] = dtUs;
+    _revSumUs += dtUs;
+    _revHead = (uint16_t)((_revHead + 1) % _revLen);
+
+    const float dt = (float)dtUs;
+    _periodEmaUs = (_periodEmaUs <= 0.0f) ? dt
+                 : (1.0f - _cfg.alphaPeriod) * _periodEmaUs + _cfg.alphaPeriod * dt;
+    if (_periodEmaUs > 0.0f) {
+      _omega = 6.28318531f * 1.0e6f / ((float)_ppr * _periodEmaUs);
+      if (_est) {
+        _est->onPulse(dt, _pulseTsUs, _omega);
+        if (_est->hasActive()) _omega = _est->activeOmega();
+      }
+      _lastSeenUs = Timebase::nowUs();
+    }
+    _sectorIdx = (_stepDir >= 0) ? (uint16_t)((_sectorIdx + 1) % _ppr)
+                                 : (uint16_t)((_sectorIdx + _ppr - 1) % _ppr);
+  }
+
+  Config   _cfg;
+  int      _ppr;
+  SpeedEstimators* _est = nullptr;
+  int8_t   _stepDir = +1;
+  uint16_t _sectorIdx = 0;
+  float    _periodEmaUs = 0.0f, _omega = 0.0f;
+  uint64_t _lastSeenUs = 0, _lastSampleUs = 0, _pulseTsUs = 0;
+  uint32_t _lastConsumed = 0, _sampleSeq = 0;
+  uint32_t _revBuf[kRevRingMax];
+  uint16_t _revLen = 1, _revHead = 0, _revFill = 0;
+  uint32_t _revSumUs = 0;
+};
+
+// Rueda host: mismo WheelT que el robot, con PID float y sin LUT ni log
+template <class Controller = PIDVel>
+using SimWheelT = WheelT<SimMotor, SimEncoder, NullCalibrator, Controller, NullLog>;
+
+#endif // SIM_WHEEL_H
@@ -0,0 +1,194 @@
+#ifndef SIM_WHEEL_DRIVE_H
+#define SIM_WHEEL_DRIVE_H
+
+#include <math.h>
+#include "SimWheel.h"
+#include "../Kinematics.h"
+#include "../Ramp.h"
+
+// ============================================================
+// SimWheelDrive — Sustituto host de DifferentialDrive sobre WheelT real
+// - Mismo camino que DifferentialDrive::update sin rutinas coordinadas:
+//   rampas (Ramp.h) -> límites -> kin::Diff2 -> re-escalado a omegaWheelMax
+//   -> WheelT (PID, dirección, freno activo, muestreo por pulso) por rueda.
+// - Planta: un SimShaft por rueda; la pose real se integra con la omega
+//   del eje y la odometría con pulsos contados, como en el robot. La
+//   diferencia entre ambas mide encoder + estimadores (truthX/Y/Theta).
+// - Sin deslizamiento ni inercia del chasis: cada rueda es su motor.
+// - Cada tick: update(dt) (control + odometría) y después stepPlant(dt),
+//   que integra los ejes y avanza el reloj virtual de Timebase (lo activa
+//   el constructor): WheelT y SpeedEstimators ven tiempos de simulación.
+// - Expone lo mismo que SimDrive para TrajectoryRunnerT/MissionBenchT.
+// ============================================================
+template <class Controller = PIDVel>
+class SimWheelDriveT {
+public:
+  typedef SimWheelT<Controller> Wheel;
+
+  struct Config {
+    float wheelRadius   = 0.05f;   // [m]
+    float trackWidth    = 0.20f;   // [m]
+    float vMax          = 0.8f;    // [m/s]
+    float wMax          = 6.0f;    // [rad/s]
+    float vAccMax       = 1.5f;    // [m/s^2]  (0 => sin rampa)
+    float wAccMax       = 10.0f;   // [rad/s^2]
+    float vDecMax       = 0.0f;    // [m/s^2]   (0 => igual que la aceleración)
+    float wDecMax       = 0.0f;    // [rad/s^2]
+    float omegaWheelMax = 120.0f;  // [rad/s]  (<=0 => desactivado)
+    float odomSignEps   = 0.05f;   // [rad/s] |omegaRef| mínima para fijar signo
+
+    SimShaft::Config        shaft;                        // ambas ruedas
+    float                   leftMagnetErrScale = -1.0f;   // izquierda: magnetErr × escala
+    typename Wheel::Config  wheel;                        // encoder.shaft lo pone el drive
+
+    Config() {
+      wheel.pid.Kp = 0.02f;   // 0.03/0.6 entra en ciclo límite
+      wheel.pid.Ki = 0.20f;
+      wheel.pid.Ts = 0.01f;
+      wheel.asyncSampling = true;   // 8 ppr: a baja omega los pulsos son escasos
+    }
+  };
+
+  explicit SimWheelDriveT(const Config& cfg)
+  : _cfg(cfg), _kin(cfg.wheelRadius, cfg.trackWidth),
+    _shR(cfg.shaft), _shL(_leftShaft_(cfg)),
+    _right(_wheelCfg_(cfg, &_shR)), _left(_wheelCfg_(cfg, &_shL)) {
+    if (!Timebase::isVirtual()) Timebase::useVirtual(true, 1000000ULL);
+    _right.begin();
+    _left.begin();
+  }
+
+  void setTwist(float v_mps, float w_radps) {
+    _vRef = (v_mps < -_cfg.vMax) ? -_cfg.vMax : (v_mps > _cfg.vMax) ? _cfg.vMax : v_mps;
+    _wRef = (w_radps < -_cfg.wMax) ? -_cfg.wMax : (w_radps > _cfg.wMax) ? _cfg.wMax : w_radps;
+  }
+
+  void update(float dt_s) {
+    if (dt_s <= 0.0f) return;
+    _vCmd = ramp::axis(_vRef, _vCmd, _cfg.vAccMax, _cfg.vDecMax, dt_s);
+    _wCmd = ramp::axis(_wRef, _wCmd, _cfg.wAccMax, _cfg.wDecMax, dt_s);
+
+    float om[kin::Diff2::kWheels];
+    _kin.inverse(_vCmd, 0.0f, _wCmd, om);
+    if (_cfg.omegaWheelMax > 0.0f) {
+      const float aMax = fmaxf(fabsf(om[0]), fabsf(om[1]));
+      if (aMax > _cfg.omegaWheelMax) {
+        const float k = _cfg.omegaWheelMax / aMax;
+        _vCmd *= k; _wCmd *= k; om[0] *= k; om[1] *= k;
+      }
+    }
+
+    // Control en t_k con los pulsos hasta ahora; la planta avanza en stepPlant()
+    _right.setOmegaRef(om[0]);
+    _left.setOmegaRef(om[1]);
+    _right.update(dt_s);
+    _left.update(dt_s);
+    _updateOdometry_();
+  }
+
+  // Planta en [t_k, t_k + dt] con los mandos del último update() y avance
+  // del reloj virtual. Fuera de update() para que la medida de CPU de
+  // MissionBench (Timebase::nowUs) no incluya el paso de simulación.
+  void stepPlant(float dt_s) {
+    if (dt_s <= 0.0f) return;
+    const uint64_t t0 = Timebase::nowUs();
+    _shR.step(_right.command(), _right.brakeApplied(), dt_s, t0);
+    _shL.step(_left.command(),  _left.brakeApplied(),  dt_s, t0);
+    Timebase::advanceUs((uint64_t)(dt_s * 1.0e6f + 0.5f));
+    _updateTruth_();
+  }
+
+  void resetOdometry(float x = 0.0f, float y = 0.0f, float theta = 0.0f) {
+    _odomX = _trueX = x; _odomY = _trueY = y; _odomTh = _trueTh = theta;
+    _odomPath = 0.0f;
+    _odomPulR = _right.pulses();
+    _odomPulL = _left.pulses();
+  }
+  float odomX()     const { return _odomX; }
+  float odomY()     const { return _odomY; }
+  float odomTheta() const { return _odomTh; }
+  float odomPath()  const { return _odomPath; }
+  float vMeas()     const { return _vMeas; }
+  float wMeas()     const { return _wMeas; }
+
+  // Pose real (ejes simulados) y deriva de la odometría respecto a ella
+  float truthX()     const { return _trueX; }
+  float truthY()     const { return _trueY; }
+  float truthTheta() const { return _trueTh; }
+  float odomDriftM() const { return hypotf(_odomX - _trueX, _odomY - _trueY); }
+
+  Wheel& right() { return _right; }
+  Wheel& left()  { return _left; }
+  const Config& config() const { return _cfg; }
+
+private:
+  static SimShaft::Config _leftShaft_(const Config& cfg) {
+    SimShaft::Config c = cfg.shaft;
+    c.magnetErr *= cfg.leftMagnetErrScale;
+    return c;
+  }
+  static typename Wheel::Config _wheelCfg_(const Config& cfg, const SimShaft* sh) {
+    typename Wheel::Config w = cfg.wheel;
+    w.encoder.shaft = sh;
+    w.encoder.pulsesPerRev = sh->config().pulsesPerRev;
+    return w;
+  }
+
+  // Igual que DifferentialDrive::_updateOdometry_
+  static uint32_t _pulseDelta_(uint32_t now, uint32_t& last) {
+    const uint32_t d = (now >= last) ? (now - last) : now;
+    last = now;
+    return d;
+  }
+  void _updateOdometry_() {
+    const float refR = _right.omegaRef(), refL = _left.omegaRef();
+    if (fabsf(refR) > _cfg.odomSignEps) _odomSgnR = (refR > 0.0f) ? +1 : -1;
+    if (fabsf(refL) > _cfg.odomSignEps) _odomSgnL = (refL > 0.0f) ? +1 : -1;
+
+    const float om[kin::Diff2::kWheels] = { _odomSgnR * _right.omegaBounded(),
+                                            _odomSgnL * _left.omegaBounded() };
+    float vy;
+    _kin.forward(om, _vMeas, vy, _wMeas);
+
+    const uint32_t nR = _pulseDelta_(_right.pulses(), _odomPulR);
+    const uint32_t nL = _pulseDelta_(_left.pulses(),  _odomPulL);
+    if (nR == 0 && nL == 0) return;
+    const float dphi[kin::Diff2::kWheels] = { _odomSgnR * (float)nR * _right.radPerPulse(),
+                                              _odomSgnL * (float)nL * _left.radPerPulse() };
+    float ds, dy, dth;
+    _kin.forward(dphi, ds, dy, dth);
+    const float thM = _odomTh + 0.5f * dth;
+    _odomX    += ds * cosf(thM);
+    _odomY    += ds * sinf(thM);
+    _odomTh   += dth;
+    _odomPath += fabsf(ds);
+  }
+
+  void _updateTruth_() {
+    const float dphi[kin::Diff2::kWheels] = { _shR.angle() - _phiR, _shL.angle() - _phiL };
+    _phiR = _shR.angle(); _phiL = _shL.angle();
+    float ds, dy, dth;
+    _kin.forward(dphi, ds, dy, dth);
+    const float thM = _trueTh + 0.5f * dth;
+    _trueX  += ds * cosf(thM);
+    _trueY  += ds * sinf(thM);
+    _trueTh += dth;
+  }
+
+  Config     _cfg;
+  kin::Diff2 _kin;
+  SimShaft   _shR, _shL;
+  Wheel      _right, _left;
+
+  float    _vRef = 0.0f, _wRef = 0.0f, _vCmd = 0.0f, _wCmd = 0.0f;
+  float    _odomX = 0.0f, _odomY = 0.0f, _odomTh = 0.0f, _odomPath = 0.0f;
+  float    _vMeas = 0.0f, _wMeas = 0.0f;
+  int8_t   _odomSgnR = +1, _odomSgnL = +1;
+  uint32_t _odomPulR = 0, _odomPulL = 0;
+  float    _trueX = 0.0f, _trueY = 0.0f, _trueTh = 0.0f;
+  float    _phiR = 0.0f, _phiL = 0.0f;
+};
+
+typedef SimWheelDriveT<> SimWheelDrive;
+
+#endif // SIM_WHEEL_DRIVE_H
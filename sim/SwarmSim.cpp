@@ -0,0 +1,202 @@
+#include "SwarmSim.h"
+#include <math.h>
+#include <chrono>
+#include <algorithm>
+
+static inline PotentialField::Config _pfConfig(const SwarmSim::Config& c) {
+  PotentialField::Config p = c.pf;
+  p.robotRadius = c.robotRadius;
+  return p;
+}
+
+SwarmSim::SwarmSim(const Config& cfg)
+: _cfg(cfg), _plant(cfg), _field(_pfConfig(cfg)),
+  _cell(2.0f * cfg.robotRadius + cfg.pf.rInfluence) {
+  if (_cfg.maxNeighbors == 0) _cfg.maxNeighbors = 1;
+  _nThreads = _cfg.threads ? _cfg.threads : std::thread::hardware_concurrency();
+  if (_nThreads == 0) _nThreads = 1;
+}
+
+SwarmSim::~SwarmSim() {
+  {
+    std::lock_guard<std::mutex> lk(_mx);
+    _quit = true;
+  }
+  _cvGo.notify_all();
+  for (size_t k=0;k<_pool.size();k++) _pool[k].join();
+}
+
+size_t SwarmSim::addRobot(float x, float y, float th, float gx, float gy) {
+  Robot r;
+  r.x = x; r.y = y; r.th = th;
+  r.gx = gx; r.gy = gy;
+  _cur.push_back(r);
+  return _cur.size() - 1;
+}
+
+bool SwarmSim::addObstacle(float x, float y, float r) {
+  return _field.addObstacle(x, y, r);
+}
+
+// ---------- Hilos ----------
+
+void SwarmSim::_start_() {
+  _started = true;
+  _next = _cur;
+  if (_nThreads > _cur.size()) _nThreads = _cur.size() ? (unsigned)_cur.size() : 1;
+  _part.assign(_nThreads, Partial());
+
+  // Cubetas: potencia de 2 >= 2N
+  uint32_t nb = 16;
+  while (nb < 2 * _cur.size()) nb <<= 1;
+  _hashMask = nb - 1;
+  _hashStart.assign(nb + 1, 0);
+  _hashIdx.assign(_cur.size(), 0);
+
+  // El hilo llamador hace el bloque 0; el resto son persistentes
+  for (unsigned k=1;k<_nThreads;k++) _pool.push_back(std::thread(&SwarmSim::_worker_, this, k));
+}
+
+void SwarmSim::_worker_(unsigned k) {
+  uint64_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lk(_mx);
+      _cvGo.wait(lk, [&]{ return _quit || _gen != seen; });
+      if (_quit) return;
+      seen = _gen;
+    }
+    const size_t n = _cur.size();
+    _stepRange_(k, n * k / _nThreads, n * (k + 1) / _nThreads);
+    {
+      std::lock_guard<std::mutex> lk(_mx);
+      if (--_pending == 0) _cvDone.notify_one();
+    }
+  }
+}
+
+// ---------- Paso ----------
+
+void SwarmSim::step() {
+  if (!_started) _start_();
+  if (_cur.empty()) return;
+  const auto t0 = std::chrono::steady_clock::now();
+
+  _buildHash_();
+  for (unsigned k=0;k<_nThreads;k++) _part[k] = Partial();
+
+  {
+    std::lock_guard<std::mutex> lk(_mx);
+    _pending = _nThreads - 1;
+    _gen++;
+  }
+  _cvGo.notify_all();
+  _stepRange_(0, 0, _cur.size() / _nThreads);
+  {
+    std::unique_lock<std::mutex> lk(_mx);
+    _cvDone.wait(lk, [&]{ return _pending == 0; });
+  }
+
+  _cur.swap(_next);
+  _st.steps++;
+  _st.simS += _cfg.dt;
+  _st.arrived = 0;
+  for (unsigned k=0;k<_nThreads;k++) {
+    const Partial& p = _part[k];
+    _st.contacts  += p.contacts;
+    _st.neighborQ += p.neighborQ;
+    _st.arrived   += p.arrived;
+    if (p.minSep < _st.minSep) _st.minSep = p.minSep;
+  }
+  _st.wallS += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+bool SwarmSim::run(uint64_t maxSteps) {
+  for (uint64_t s=0;s<maxSteps;s++) {
+    step();
+    if (allArrived()) return true;
+  }
+  return allArrived();
+}
+
+void SwarmSim::_buildHash_() {
+  // Ordenación por conteo: cubeta -> índices contiguos
+  const size_t n = _cur.size();
+  const float inv = 1.0f / _cell;
+  std::fill(_hashStart.begin(), _hashStart.end(), 0);
+  for (size_t i=0;i<n;i++) {
+    const uint32_t b = _bucket_((int32_t)floorf(_cur[i].x * inv), (int32_t)floorf(_cur[i].y * inv));
+    _hashStart[b + 1]++;
+  }
+  for (size_t b=1;b<_hashStart.size();b++) _hashStart[b] += _hashStart[b - 1];
+  _hashCursor.assign(_hashStart.begin(), _hashStart.end() - 1);
+  for (size_t i=0;i<n;i++) {
+    const uint32_t b = _bucket_((int32_t)floorf(_cur[i].x * inv), (int32_t)floorf(_cur[i].y * inv));
+    _hashIdx[_hashCursor[b]++] = (uint32_t)i;
+  }
+}
+
+void SwarmSim::_stepRange_(unsigned k, size_t a, size_t b) {
+  std::vector<PotentialField::Obstacle> nb(_cfg.maxNeighbors);
+  Partial& acc = _part[k];
+  for (size_t i=a;i<b;i++) _stepRobot_(i, nb.data(), acc);
+}
+
+void SwarmSim::_stepRobot_(size_t i, PotentialField::Obstacle* nb, Partial& acc) {
+  const Robot& r = _cur[i];
+  Robot& o = _next[i];
+  o = r;
+
+  // Vecinos en las 9 celdas; si sobran se quedan los más cercanos
+  const float inv = 1.0f / _cell;
+  const int32_t cx = (int32_t)floorf(r.x * inv), cy = (int32_t)floorf(r.y * inv);
+  const float reach2 = _cell * _cell, contact2 = 4.0f * _cfg.robotRadius * _cfg.robotRadius;
+  float   d2[256];
+  uint8_t nNb = 0;
+  const uint8_t cap = _cfg.maxNeighbors;
+  // Con pocas cubetas dos celdas vecinas pueden caer en la misma: se recorre
+  // cada cubeta una sola vez (si no, vecinos, contactos y neighborQ se duplican)
+  uint32_t seen[9];
+  uint8_t  nSeen = 0;
+  for (int32_t dy=-1;dy<=1;dy++) for (int32_t dx=-1;dx<=1;dx++) {
+    const uint32_t bk = _bucket_(cx + dx, cy + dy);
+    bool dup = false;
+    for (uint8_t m=0;m<nSeen;m++) if (seen[m] == bk) { dup = true; break; }
+    if (dup) continue;
+    seen[nSeen++] = bk;
+    for (uint32_t q=_hashStart[bk]; q<_hashStart[bk + 1]; q++) {
+      const uint32_t j = _hashIdx[q];
+      if (j == i) continue;
+      const Robot& s = _cur[j];
+      const float ex = s.x - r.x, ey = s.y - r.y, e2 = ex*ex + ey*ey;
+      acc.neighborQ++;
+      if (e2 >= reach2) continue;     // otra celda con la misma cubeta o fuera de alcance
+      if (j > i) {
+        const float sep = sqrtf(e2);
+        if (sep < acc.minSep) acc.minSep = sep;
+        if (e2 < contact2) acc.contacts++;
+      }
+      uint8_t slot = nNb;
+      if (nNb < cap) nNb++;
+      else {
+        slot = 0;
+        for (uint8_t m=1;m<cap;m++) if (d2[m] > d2[slot]) slot = m;
+        if (d2[slot] <= e2) continue;
+      }
+      nb[slot].x = s.x; nb[slot].y = s.y; nb[slot].r = _cfg.robotRadius;
+      d2[slot] = e2;
+    }
+  }
+
+  // Planificador: en meta queda quieto (sigue siendo obstáculo para los demás)
+  float vRef = 0.0f, wRef = 0.0f;
+  if (r.tArrive < 0.0f) {
+    PotentialField pf(_field);
+    pf.setGoal(r.gx, r.gy);
+    if (pf.twist(r.x, r.y, r.th, vRef, wRef, nb, nNb)) o.tArrive = (float)(_st.simS + _cfg.dt);
+  }
+  if (o.tArrive >= 0.0f) acc.arrived++;
+
+  // Rampas/límites de DifferentialDrive + cinemática + integración
+  _plant.step(r, o, vRef, wRef, _cfg.dt);
+}
@@ -0,0 +1,114 @@
+#ifndef SWARM_SIM_H
+#define SWARM_SIM_H
+
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "../PotentialField.h"
+#include "DiffPlant.h"
+
+// ============================================================
+// SwarmSim — Simulador host de N robots con campos de potencial
+// - Solo host (std::thread); no forma parte del sketch.
+// - Cada robot: PotentialField (obstáculos fijos + vecinos como repulsores)
+//   -> DiffPlant (rampas/límites de DifferentialDrive, kin::Diff2, punto medio).
+//   Planta cinemática: sin PID/PWM/encoders (eso no corre fuera del ESP32).
+// - Paso en lockstep con doble búfer: todos leen el estado del paso k y
+//   escriben el k+1, así el resultado no depende del número de hilos.
+// - Vecinos: hash espacial (celda = alcance de la repulsión entre robots),
+//   reconstruido por ordenación por conteo en cada paso (O(N)).
+// - Robots repartidos en bloques contiguos entre hilos persistentes.
+//
+// Compilar (desde la raíz del repo):
+//   g++ -O2 -std=c++11 -pthread sim/SwarmSim.cpp sim/swarm_main.cpp PotentialField.cpp -o swarm
+// ============================================================
+class SwarmSim {
+public:
+  // Planta (DiffPlant::Config) + escenario
+  struct Config : DiffPlant::Config {
+    float dt = 0.01f;              // [s] paso de simulación
+
+    float   robotRadius  = 0.12f;  // [m] huella (colisión y repulsión)
+    uint8_t maxNeighbors = 16;     // repulsores por robot y paso (los más cercanos)
+    unsigned threads     = 0;      // 0 => hardware_concurrency()
+
+    PotentialField::Config pf;     // pf.robotRadius se fuerza a robotRadius
+  };
+
+  struct Robot : DiffPlant::State {        // pose, twist y camino
+    float gx = 0.0f, gy = 0.0f;            // meta
+    float tArrive = -1.0f;                 // [s] (<0 => en camino)
+  };
+
+  struct Stats {
+    uint64_t steps      = 0;
+    double   simS       = 0.0;
+    double   wallS      = 0.0;
+    uint32_t arrived    = 0;
+    uint64_t contacts   = 0;      // pares·paso a menos de 2·robotRadius
+    float    minSep     = 1.0e9f; // [m] centro a centro
+    uint64_t neighborQ  = 0;      // vecinos evaluados (coste del hash)
+  };
+
+  explicit SwarmSim(const Config& cfg);
+  ~SwarmSim();
+
+  // Antes del primer step()
+  size_t addRobot(float x, float y, float th, float gx, float gy);
+  bool   addObstacle(float x, float y, float r);
+
+  void step();
+  // Hasta maxSteps o todos en meta; devuelve true si llegaron todos
+  bool run(uint64_t maxSteps);
+
+  bool         allArrived() const { return _st.arrived == _cur.size(); }
+  size_t       size()       const { return _cur.size(); }
+  const Robot& robot(size_t i) const { return _cur[i]; }
+  const Stats& stats()      const { return _st; }
+  unsigned     threads()    const { return _nThreads; }
+
+private:
+  struct Partial {                 // acumulados por hilo (sin compartir líneas)
+    uint64_t contacts = 0, neighborQ = 0;
+    uint32_t arrived = 0;
+    float    minSep = 1.0e9f;
+    char     pad[64];
+  };
+
+  void _start_();
+  void _worker_(unsigned k);
+  void _stepRange_(unsigned k, size_t a, size_t b);
+  void _stepRobot_(size_t i, PotentialField::Obstacle* nb, Partial& acc);
+  void _buildHash_();
+  inline uint32_t _bucket_(int32_t cx, int32_t cy) const {
+    return ((uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u) & _hashMask;
+  }
+
+  Config                _cfg;
+  DiffPlant             _plant;
+  PotentialField        _field;    // obstáculos fijos (la meta va por robot)
+  float                 _cell;     // [m] lado de celda del hash
+
+  std::vector<Robot>    _cur, _next;
+
+  // Hash espacial: cubetas -> rango en _hashIdx
+  std::vector<uint32_t> _hashStart, _hashIdx, _hashCursor;
+  uint32_t              _hashMask = 0;
+
+  // Hilos: generación de paso + contador de terminados
+  std::vector<std::thread> _pool;
+  std::vector<Partial>     _part;
+  unsigned                 _nThreads = 1;
+  std::mutex               _mx;
+  std::condition_variable  _cvGo, _cvDone;
+  uint64_t                 _gen = 0;
+  unsigned                 _pending = 0;
+  bool                     _quit = false;
+  bool                     _started = false;
+
+  Stats _st;
+};
+
+#endif // SWARM_SIM_H
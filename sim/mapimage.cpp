@@ -0,0 +1,236 @@
+#include "../MapPartition.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <queue>
+#include <functional>
+
+// ============================================================
+// mapimage — Genera la imagen de MapPartition (herramienta de host)
+//   mapimage out.bin [--pgm mapa.pgm | --demo W H] [--res 0.05]
+//            [--origin x y] [--goal x y] [--radius 0.12] [--tile 4]
+// - PGM binario (P5), convención map_server: <100 ocupado, >230 libre,
+//   resto desconocido. --demo: sala con obstáculos para pruebas.
+// - Capas: Occupancy (int8 log-odds saturado), Distance (EDT exacta en mm),
+//   Navigation (Dijkstra 8-conexo hasta la meta evitando celdas a menos de
+//   --radius de un obstáculo) si se da --goal.
+// - Imprime la línea de partitions.csv y el comando para flashearla.
+// Compilar (desde la raíz del repo):
+//   g++ -O2 -std=c++11 sim/mapimage.cpp MapPartition.cpp -o mapimage
+// ============================================================
+
+enum Cell : uint8_t { kFree, kUnknown, kOcc };
+
+static bool loadPgm(const char* path, int& w, int& h, std::vector<uint8_t>& cells) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  char magic[3] = {0};
+  int maxv = 0;
+  if (fscanf(f, "%2s", magic) != 1 || strcmp(magic, "P5") != 0) { fclose(f); return false; }
+  // Comentarios '#' entre campos
+  int vals[3], n = 0;
+  while (n < 3) {
+    int c = fgetc(f);
+    if (c == '#') { while (c != '\n' && c != EOF) c = fgetc(f); continue; }
+    if (c == EOF) { fclose(f); return false; }
+    if (c >= '0' && c <= '9') { ungetc(c, f); if (fscanf(f, "%d", &vals[n]) != 1) { fclose(f); return false; } n++; }
+  }
+  w = vals[0]; h = vals[1]; maxv = vals[2];
+  fgetc(f);
+  if (maxv > 255 || w <= 0 || h <= 0) { fclose(f); return false; }
+  std::vector<uint8_t> px((size_t)w * h);
+  if (fread(px.data(), 1, px.size(), f) != px.size()) { fclose(f); return false; }
+  fclose(f);
+  // PGM: fila 0 arriba; mapa: fila 0 abajo (y crece hacia arriba)
+  cells.assign(px.size(), kUnknown);
+  for (int y=0;y<h;y++) for (int x=0;x<w;x++) {
+    const uint8_t v = px[(size_t)(h - 1 - y) * w + x];
+    cells[(size_t)y * w + x] = (v < 100) ? kOcc : (v > 230) ? kFree : kUnknown;
+  }
+  return true;
+}
+
+static void demoMap(int w, int h, std::vector<uint8_t>& cells) {
+  cells.assign((size_t)w * h, kFree);
+  for (int x=0;x<w;x++) { cells[x] = kOcc; cells[(size_t)(h - 1) * w + x] = kOcc; }
+  for (int y=0;y<h;y++) { cells[(size_t)y * w] = kOcc; cells[(size_t)y * w + w - 1] = kOcc; }
+  // Tabique con puerta y dos pilares
+  for (int y=0;y<h*2/3;y++) cells[(size_t)y * w + w / 2] = kOcc;
+  const int pr = (w < h ? w : h) / 16 + 1;
+  const int pc[2][2] = { { w / 4, h / 2 }, { 3 * w / 4, h / 3 } };
+  for (int k=0;k<2;k++)
+    for (int y=-pr;y<=pr;y++) for (int x=-pr;x<=pr;x++)
+      if (x*x + y*y <= pr*pr) cells[(size_t)(pc[k][1] + y) * w + pc[k][0] + x] = kOcc;
+}
+
+// EDT exacta 1D (Felzenszwalb–Huttenlocher) sobre f en su sitio
+static void edt1d(std::vector<float>& f, int n, std::vector<float>& d, std::vector<int>& v, std::vector<float>& z) {
+  const float INF = 1e20f;
+  int k = 0;
+  v[0] = 0; z[0] = -INF; z[1] = INF;
+  for (int q=1;q<n;q++) {
+    float s = ((f[q] + (float)q*q) - (f[v[k]] + (float)v[k]*v[k])) / (2.0f * q - 2.0f * v[k]);
+    while (s <= z[k]) {                          // z[0] = -INF corta en k = 0
+      k--;
+      s = ((f[q] + (float)q*q) - (f[v[k]] + (float)v[k]*v[k])) / (2.0f * q - 2.0f * v[k]);
+    }
+    k++; v[k] = q; z[k] = s; z[k + 1] = INF;
+  }
+  k = 0;
+  for (int q=0;q<n;q++) {
+    while (z[k + 1] < q) k++;
+    d[q] = (float)(q - v[k]) * (q - v[k]) + f[v[k]];
+  }
+  for (int q=0;q<n;q++) f[q] = d[q];
+}
+
+static void edt2d(const std::vector<uint8_t>& cells, int w, int h, std::vector<float>& dist2) {
+  const float INF = 1e20f;
+  dist2.assign((size_t)w * h, INF);
+  for (size_t i=0;i<cells.size();i++) if (cells[i] == kOcc) dist2[i] = 0.0f;
+  const int m = (w > h) ? w : h;
+  std::vector<float> f(m), d(m), z(m + 1);
+  std::vector<int> v(m);
+  for (int x=0;x<w;x++) {
+    for (int y=0;y<h;y++) f[y] = dist2[(size_t)y * w + x];
+    edt1d(f, h, d, v, z);
+    for (int y=0;y<h;y++) dist2[(size_t)y * w + x] = f[y];
+  }
+  for (int y=0;y<h;y++) {
+    for (int x=0;x<w;x++) f[x] = dist2[(size_t)y * w + x];
+    edt1d(f, w, d, v, z);
+    for (int x=0;x<w;x++) dist2[(size_t)y * w + x] = f[x];
+  }
+}
+
+static void navField(const std::vector<float>& dist2, int w, int h, float res, float radius,
+                     int gx, int gy, std::vector<uint16_t>& cost) {
+  cost.assign((size_t)w * h, MapPartition::kUnreachable);
+  const float r2 = (radius / res) * (radius / res);
+  std::vector<uint32_t> best((size_t)w * h, 0xFFFFFFFFu);
+  typedef std::pair<uint32_t, uint32_t> Item;   // (coste mm, índice)
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item> > pq;
+  const size_t g = (size_t)gy * w + gx;
+  best[g] = 0; pq.push(Item(0, (uint32_t)g));
+  const uint32_t step = (uint32_t)lroundf(res * 1000.0f), diag = (uint32_t)lroundf(res * 1414.2136f);
+  while (!pq.empty()) {
+    const Item it = pq.top(); pq.pop();
+    if (it.first != best[it.second]) continue;
+    const int x = (int)(it.second % w), y = (int)(it.second / w);
+    for (int dy=-1;dy<=1;dy++) for (int dx=-1;dx<=1;dx++) {
+      if ((dx | dy) == 0) continue;
+      const int nx = x + dx, ny = y + dy;
+      if (nx < 0 || ny < 0 || nx >= w || ny >= h) continue;
+      const size_t ni = (size_t)ny * w + nx;
+      if (dist2[ni] < r2) continue;                  // dentro del radio del robot
+      const uint32_t c = it.first + ((dx && dy) ? diag : step);
+      if (c < best[ni]) { best[ni] = c; pq.push(Item(c, (uint32_t)ni)); }
+    }
+  }
+  for (size_t i=0;i<best.size();i++) cost[i] = (best[i] < 0xFFFFu) ? (uint16_t)best[i] : MapPartition::kUnreachable;
+}
+
+static uint32_t alignUp(uint32_t v, uint32_t a) { return (v + a - 1) / a * a; }
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "uso: %s out.bin [--pgm f.pgm | --demo W H] [--res m] [--origin x y] "
+                    "[--goal x y] [--radius m] [--tile shift]\n", argv[0]);
+    return 2;
+  }
+  const char* out = argv[1];
+  const char* pgm = nullptr;
+  int w = 128, h = 96, tileShift = 4;
+  float res = 0.05f, ox = 0.0f, oy = 0.0f, radius = 0.12f, goalX = 0.0f, goalY = 0.0f;
+  bool hasGoal = false, hasOrigin = false;
+  for (int i=2;i<argc;i++) {
+    if      (!strcmp(argv[i], "--pgm")    && i + 1 < argc) pgm = argv[++i];
+    else if (!strcmp(argv[i], "--demo")   && i + 2 < argc) { w = atoi(argv[++i]); h = atoi(argv[++i]); }
+    else if (!strcmp(argv[i], "--res")    && i + 1 < argc) res = (float)atof(argv[++i]);
+    else if (!strcmp(argv[i], "--origin") && i + 2 < argc) { ox = (float)atof(argv[++i]); oy = (float)atof(argv[++i]); hasOrigin = true; }
+    else if (!strcmp(argv[i], "--goal")   && i + 2 < argc) { goalX = (float)atof(argv[++i]); goalY = (float)atof(argv[++i]); hasGoal = true; }
+    else if (!strcmp(argv[i], "--radius") && i + 1 < argc) radius = (float)atof(argv[++i]);
+    else if (!strcmp(argv[i], "--tile")   && i + 1 < argc) tileShift = atoi(argv[++i]);
+    else { fprintf(stderr, "argumento desconocido: %s\n", argv[i]); return 2; }
+  }
+  if (tileShift < 1 || tileShift > 7) { fprintf(stderr, "--tile fuera de 1..7\n"); return 2; }
+
+  std::vector<uint8_t> cells;
+  if (pgm) { if (!loadPgm(pgm, w, h, cells)) { fprintf(stderr, "PGM no válido: %s\n", pgm); return 1; } }
+  else demoMap(w, h, cells);
+  if (w > 65535 || h > 65535) { fprintf(stderr, "mapa demasiado grande\n"); return 1; }
+  if (!hasOrigin) { ox = -0.5f * w * res; oy = -0.5f * h * res; }   // centrado en (0,0)
+
+  std::vector<float> dist2;
+  edt2d(cells, w, h, dist2);
+
+  std::vector<uint16_t> nav;
+  int gcx = 0, gcy = 0;
+  if (hasGoal) {
+    gcx = (int)floorf((goalX - ox) / res); gcy = (int)floorf((goalY - oy) / res);
+    if (gcx < 0 || gcy < 0 || gcx >= w || gcy >= h) { fprintf(stderr, "meta fuera del mapa\n"); return 1; }
+    navField(dist2, w, h, res, radius, gcx, gcy, nav);
+  }
+
+  // Disposición
+  const uint32_t ts = 1u << tileShift;
+  const uint32_t tilesX = (w + ts - 1) / ts, tilesY = (h + ts - 1) / ts;
+  const uint32_t nCells = tilesX * tilesY * ts * ts;
+  MapPartition::Header hd;
+  memset(&hd, 0, sizeof(hd));
+  hd.magic = MapPartition::kMagic;
+  hd.version = MapPartition::kVersion;
+  hd.headerBytes = sizeof(hd);
+  hd.width = (uint16_t)w; hd.height = (uint16_t)h;
+  hd.resolution = res; hd.originX = ox; hd.originY = oy;
+  hd.tileShift = (uint8_t)tileShift;
+  hd.tilesX = (uint16_t)tilesX; hd.tilesY = (uint16_t)tilesY;
+  hd.goalX = (uint16_t)gcx; hd.goalY = (uint16_t)gcy;
+  const uint8_t cb[MapPartition::kLayerCount] = { 1, 2, 2 };
+  uint32_t off = MapPartition::kLayerAlign;
+  for (uint8_t l=0;l<MapPartition::kLayerCount;l++) {
+    if (l == MapPartition::Navigation && !hasGoal) continue;
+    hd.layerMask |= (uint8_t)(1u << l);
+    hd.cellBytes[l] = cb[l];
+    hd.layerOffset[l] = off;
+    off = alignUp(off + nCells * cb[l], MapPartition::kLayerAlign);
+  }
+  const uint32_t total = off;
+  hd.payloadBytes = total - hd.headerBytes;
+
+  std::vector<uint8_t> img(total, 0);
+  // Celdas de relleno (fuera de w x h): ocupadas, distancia 0, inalcanzables
+  for (uint8_t l=0;l<MapPartition::kLayerCount;l++) {
+    if (!((hd.layerMask >> l) & 1u)) continue;
+    for (uint32_t ty=0;ty<tilesY;ty++) for (uint32_t tx=0;tx<tilesX;tx++)
+      for (uint32_t iy=0;iy<ts;iy++) for (uint32_t ix=0;ix<ts;ix++) {
+        const uint32_t x = tx * ts + ix, y = ty * ts + iy;
+        const bool in = (x < (uint32_t)w && y < (uint32_t)h);
+        const size_t ci = (size_t)y * w + x;
+        uint8_t* p = img.data() + hd.layerOffset[l] + (((ty * tilesX + tx) * ts * ts) + iy * ts + ix) * cb[l];
+        if (l == MapPartition::Occupancy) {
+          const int8_t v = !in ? 64 : (cells[ci] == kOcc) ? 64 : (cells[ci] == kFree) ? -64 : 0;
+          p[0] = (uint8_t)v;
+        } else {
+          uint16_t v;
+          if (l == MapPartition::Distance) v = in ? (uint16_t)fminf(sqrtf(dist2[ci]) * res * 1000.0f, 65534.0f) : 0;
+          else                            v = in ? nav[ci] : MapPartition::kUnreachable;
+          p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8);
+        }
+      }
+  }
+  hd.crc32 = MapPartition::crc32(img.data() + hd.headerBytes, hd.payloadBytes);
+  memcpy(img.data(), &hd, sizeof(hd));
+
+  FILE* f = fopen(out, "wb");
+  if (!f || fwrite(img.data(), 1, img.size(), f) != img.size()) { fprintf(stderr, "no se pudo escribir %s\n", out); return 1; }
+  fclose(f);
+
+  printf("[MAP] %s: %dx%d @ %.3f m  tiles %ux%u de %u  capas 0x%x  %u B\n", out, w, h, (double)res,
+         tilesX, tilesY, ts, (unsigned)hd.layerMask, total);
+  printf("[MAP] partitions.csv:  maps, data, 0x40, , 0x%X\n", alignUp(total, 0x10000));
+  printf("[MAP] flashear:        parttool.py write_partition --partition-name maps --input %s\n", out);
+  return 0;
+}
@@ -0,0 +1,142 @@
+#include "SimDrive.h"
+#include "SimWheelDrive.h"
+#include "../TrajectoryRunnerImpl.h"
+#include "../MissionBenchImpl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+// ============================================================
+// mission — MissionBench sobre una planta del simulador
+//   mission [mision=all|square|p2p|slalom|obstacles] [dt s=0.01] [escala E=0] [planta=kin|wheel]
+// Mismo código de misiones y runner que en el robot. Devuelve 0 si todas
+// llegan a meta.
+// - kin: DiffPlant (rampas + cinemática, encoders ideales). Mide solo
+//   planificador + rampas; no ve cambios en Wheel ni en SpeedEstimators.
+// - wheel: SimWheelDrive = WheelT real (PID, dirección, freno activo,
+//   muestreo por pulso, SpeedEstimators) sobre motores de primer orden y
+//   encoders de un canal; odometría por pulsos contados. Añade la deriva
+//   odometría-verdad. Reloj virtual: las columnas de CPU quedan a 0.
+// - escala E >= 1: corre las misiones dos veces, con trapezoide y con
+//   mínima energía (MissionBench::Config::energyTimeScale = E), y añade la
+//   tabla comparativa de tiempo/energía por misión.
+//
+// Compilar (desde la raíz del repo):
+//   g++ -O2 -std=c++11 sim/mission_main.cpp PotentialField.cpp Timebase.cpp PIDVel.cpp SpeedEstimators.cpp -o mission
+// ============================================================
+static const uint8_t kMissions = MissionBenchT<SimDrive>::kMissionCount;
+
+struct StdoutOut {
+  int printf(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    const int n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+  }
+};
+
+// Resumen por misión (común a ambas plantas)
+struct Row {
+  bool  valid = false, reached = false;
+  float timeS = 0.0f, energyJ = 0.0f;
+};
+
+// La planta de ruedas avanza fuera del tick medido por el banco
+static void stepPlant(SimDrive&, float) {}
+static void stepPlant(SimWheelDrive& d, float dt) { d.stepPlant(dt); }
+
+static void printPlant(const SimDrive&) {}
+static void printPlant(const SimWheelDrive& d) {
+  printf("[mission] odometría vs verdad: %.3f m, %.3f rad\n",
+         (double)d.odomDriftM(), (double)kin::wrapPi(d.odomTheta() - d.truthTheta()));
+}
+
+// Una corrida completa con su propio drive/runner (misma condición inicial)
+template <class Drive>
+static bool runBench(float energyScale, const char* which, float dt, Row (&rows)[kMissions]) {
+  typedef MissionBenchT<Drive> Bench;
+  typename Bench::Config bc;
+  bc.energyTimeScale = energyScale;
+
+  Drive drive((typename Drive::Config()));
+  TrajectoryRunnerT<Drive> runner((typename TrajectoryRunnerT<Drive>::Config()), drive);
+  Bench bench(bc, runner);
+
+  bool ok = false;
+  if (strcmp(which, "all") == 0) ok = bench.startAll();
+  for (uint8_t m=0; !ok && m<kMissions; m++)
+    if (strcmp(which, Bench::name((typename Bench::Mission)m)) == 0) ok = bench.start((typename Bench::Mission)m);
+  if (!ok) { fprintf(stderr, "[mission] misión desconocida: %s\n", which); return false; }
+
+  // Tope: todas las misiones con timeout y pausa
+  const uint64_t maxSteps = (uint64_t)(kMissions * (bc.timeoutS + bc.settleS + 1.0f) / dt);
+  uint64_t steps = 0;
+  while (bench.busy() && steps < maxSteps) { bench.update(dt); stepPlant(drive, dt); steps++; }
+
+  StdoutOut out;
+  printf("[mission] plan: %s\n", (bc.energyTimeScale > 0.0f) ? "mínima energía" : "trapezoide");
+  bench.printScorecard(out);
+  printf("[mission] %llu pasos  dt=%.3f s  sim %.2f s\n",
+         (unsigned long long)steps, (double)dt, (double)(steps * dt));
+  printPlant(drive);
+
+  for (uint8_t m=0;m<kMissions;m++) {
+    const typename Bench::Result& r = bench.result((typename Bench::Mission)m);
+    rows[m].valid = r.valid; rows[m].reached = r.reached;
+    rows[m].timeS = r.timeS; rows[m].energyJ = r.energyJ;
+  }
+  return true;
+}
+
+static bool allReached(const Row (&rows)[kMissions]) {
+  for (uint8_t m=0;m<kMissions;m++)
+    if (rows[m].valid && !rows[m].reached) return false;
+  return true;
+}
+
+static bool run(bool wheel, float energyScale, const char* which, float dt, Row (&rows)[kMissions]) {
+  return wheel ? runBench<SimWheelDrive>(energyScale, which, dt, rows)
+               : runBench<SimDrive>(energyScale, which, dt, rows);
+}
+
+int main(int argc, char** argv) {
+  const char* which = (argc > 1) ? argv[1] : "all";
+  const float dt    = (argc > 2) ? (float)atof(argv[2]) : 0.01f;
+  const float scale = (argc > 3) ? (float)atof(argv[3]) : 0.0f;
+  const bool  wheel = (argc > 4) && strcmp(argv[4], "wheel") == 0;
+  if (argc > 4 && !wheel && strcmp(argv[4], "kin") != 0) {
+    fprintf(stderr, "[mission] planta desconocida: %s\n", argv[4]);
+    return 2;
+  }
+  printf("[mission] planta: %s\n", wheel ? "wheel (WheelT + motor/encoder simulados)" : "kin (DiffPlant)");
+
+  Row trap[kMissions];
+  if (!run(wheel, 0.0f, which, dt, trap)) return 2;
+  if (scale <= 0.0f) return allReached(trap) ? 0 : 1;
+
+  const float eScale = (scale < 1.0f) ? 1.0f : scale;
+  Row minE[kMissions];
+  if (!run(wheel, eScale, which, dt, minE)) return 2;
+
+  // Comparativa: trapezoide vs mínima energía
+  printf("[mission] %-10s %8s %8s | %8s %8s | %7s  (escala %.2f)\n",
+         "mision", "t[s]", "E[J]", "t minE", "E minE", "dE[%]", (double)eScale);
+  float tT = 0.0f, eT = 0.0f, tE = 0.0f, eE = 0.0f;
+  for (uint8_t m=0;m<kMissions;m++) {
+    const Row& a = trap[m];
+    const Row& b = minE[m];
+    if (!a.valid || !b.valid) continue;
+    tT += a.timeS; eT += a.energyJ; tE += b.timeS; eE += b.energyJ;
+    printf("[mission] %-10s %8.2f %8.2f | %8.2f %8.2f | %+7.1f\n",
+           MissionBenchT<SimDrive>::name((MissionBenchT<SimDrive>::Mission)m),
+           (double)a.timeS, (double)a.energyJ, (double)b.timeS, (double)b.energyJ,
+           (a.energyJ > 0.0f) ? (double)(100.0f * (b.energyJ - a.energyJ) / a.energyJ) : 0.0);
+  }
+  printf("[mission] %-10s %8.2f %8.2f | %8.2f %8.2f | %+7.1f\n", "total",
+         (double)tT, (double)eT, (double)tE, (double)eE,
+         (eT > 0.0f) ? (double)(100.0f * (eE - eT) / eT) : 0.0);
+
+  return (allReached(trap) && allReached(minE)) ? 0 : 1;
+}
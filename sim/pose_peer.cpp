@@ -0,0 +1,56 @@
+#include "../PoseBroadcast.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <thread>
+#include <chrono>
+
+// ============================================================
+// pose_peer — Un "robot" de prueba para PoseBroadcast en localhost
+//   pose_peer <id> [segundos=5]
+// Recorre un círculo de 1 m (fase según id) publicando a 20 Hz por el
+// grupo multicast en 127.0.0.1; cada segundo imprime vecinos y repulsores.
+// Lanzar varios procesos a la vez para una flota local:
+//   g++ -O2 -std=c++11 -pthread sim/pose_peer.cpp PoseBroadcast.cpp PotentialField.cpp Timebase.cpp -o pose_peer
+//   ./pose_peer 1 & ./pose_peer 2 & ./pose_peer 3
+// ============================================================
+int main(int argc, char** argv) {
+  PoseBroadcast::Config cfg;
+  cfg.id        = (argc > 1) ? (uint8_t)atoi(argv[1]) : 1;
+  cfg.localhost = true;
+  cfg.range     = 10.0f;
+  const float secs = (argc > 2) ? (float)atof(argv[2]) : 5.0f;
+
+  PoseBroadcast pb(cfg);
+  if (!pb.begin()) { fprintf(stderr, "[peer %u] sin socket multicast\n", (unsigned)cfg.id); return 1; }
+
+  const float R = 1.0f, w = 0.5f, ph = 0.8f * cfg.id;
+  const uint64_t t0 = Timebase::nowUs();
+  uint32_t lastPrint = 0;
+  for (;;) {
+    const float t = (Timebase::nowUs() - t0) * 1e-6f;
+    if (t >= secs) break;
+    const float a = ph + w * t;
+    const float x = R * cosf(a), y = R * sinf(a);
+    pb.update(x, y, a + 0.5f * (float)M_PI, R * w, w);
+
+    if ((uint32_t)t != lastPrint) {
+      lastPrint = (uint32_t)t;
+      PoseBroadcast::NeighborPose nb[PoseBroadcast::kMaxNeighbors];
+      PotentialField::Obstacle rp[2 * PoseBroadcast::kMaxNeighbors];
+      const uint8_t n = pb.neighbors(nb, PoseBroadcast::kMaxNeighbors);
+      const uint8_t m = pb.repulsors(x, y, rp, 2 * PoseBroadcast::kMaxNeighbors);
+      printf("[peer %u] t=%u s  vecinos=%u repulsores=%u", (unsigned)cfg.id, (unsigned)lastPrint,
+             (unsigned)n, (unsigned)m);
+      for (uint8_t i=0;i<n;i++)
+        printf("  #%u(%.2f,%.2f %ums)", (unsigned)nb[i].id, (double)nb[i].x, (double)nb[i].y, (unsigned)nb[i].ageMs);
+      printf("\n");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  const PoseBroadcast::Stats& st = pb.stats();
+  printf("[peer %u] tx=%u rx=%u propios=%u perdidos=%u malos=%u\n", (unsigned)cfg.id,
+         (unsigned)st.tx, (unsigned)st.rx, (unsigned)st.own, (unsigned)st.lost, (unsigned)st.bad);
+  return 0;
+}
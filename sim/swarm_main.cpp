@@ -0,0 +1,50 @@
+#include "SwarmSim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// ============================================================
+// swarm — Escenario de intercambio en círculo
+//   swarm [N=200] [hilos=0] [tMax s=300] [sideBias=0.5]
+// N robots en un círculo, cada uno con meta en el punto opuesto: todos
+// cruzan el centro y la repulsión entre robots debe resolver el cruce.
+// Imprime llegadas, contactos, separación mínima y factor sobre tiempo real.
+// ============================================================
+int main(int argc, char** argv) {
+  const int      n     = (argc > 1) ? atoi(argv[1]) : 200;
+  const unsigned thr   = (argc > 2) ? (unsigned)atoi(argv[2]) : 0;
+  const float    tMax  = (argc > 3) ? (float)atof(argv[3]) : 300.0f;
+
+  SwarmSim::Config cfg;
+  cfg.threads = thr;
+  cfg.pf.sideBias = (argc > 4) ? (float)atof(argv[4]) : 0.5f;   // todos ceden por la derecha
+  SwarmSim sim(cfg);
+
+  // Perímetro ~0.5 m por robot
+  const float R = fmaxf(1.0f, 0.5f * n / (2.0f * (float)M_PI));
+  for (int i=0;i<n;i++) {
+    const float a = 2.0f * (float)M_PI * i / n;
+    const float x = R * cosf(a), y = R * sinf(a);
+    sim.addRobot(x, y, a + (float)M_PI, -x, -y);
+  }
+
+  const uint64_t maxSteps = (uint64_t)(tMax / cfg.dt);
+  const bool all = sim.run(maxSteps);
+  const SwarmSim::Stats& st = sim.stats();
+
+  float tLast = 0.0f, pathSum = 0.0f;
+  for (size_t i=0;i<sim.size();i++) {
+    if (sim.robot(i).tArrive > tLast) tLast = sim.robot(i).tArrive;
+    pathSum += sim.robot(i).path;
+  }
+
+  printf("[SWARM] N=%d hilos=%u R=%.2f m\n", n, sim.threads(), (double)R);
+  printf("[SWARM] en meta %u/%d%s  última llegada %.2f s  camino medio %.2f m\n",
+         (unsigned)st.arrived, n, all ? "" : " (tMax)", (double)tLast, (double)(pathSum / n));
+  printf("[SWARM] contactos %llu par·paso  separación mínima %.3f m  vecinos/robot·paso %.1f\n",
+         (unsigned long long)st.contacts, (double)st.minSep,
+         st.steps ? (double)st.neighborQ / ((double)st.steps * n) : 0.0);
+  printf("[SWARM] %llu pasos  sim %.2f s  real %.3f s  x%.1f tiempo real\n",
+         (unsigned long long)st.steps, st.simS, st.wallS, st.wallS > 0.0 ? st.simS / st.wallS : 0.0);
+  return all ? 0 : 1;
+}